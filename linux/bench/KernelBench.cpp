@@ -0,0 +1,456 @@
+/***********************************
+ *
+ * Logic evaluation benchmark and regression check on host.
+ *
+ * GATE and invalid logic functions are evaluated in channel pipeline by
+ * processLogic() with the kernel bound during decodeParams(), AND, OR and
+ * EXOR are evaluated in batch by Logic::processLogicBatch(). Both paths are
+ * driven like on the device: input telegrams are received on the input KO of
+ * randomized channels (all logic functions, disabled channels, invalid
+ * evaluation, negated and inactive inputs, gate triggers) and Logic::loop()
+ * processes them. Each output telegram has to match the switch based
+ * evaluation, which read logic and gate parameters from parameter memory on
+ * each call (as it was before kernels and batch evaluation were introduced).
+ * Batch evaluation gets also random states of all four inputs through
+ * Logic::updateLogicBatch(), with several channels changed before the next
+ * loop and with channels changed during their startup delay, which have to
+ * be evaluated when they start running.
+ * Afterwards the time from input telegram to output telegram is reported for
+ * both paths, and the time per channel of batch evaluation is compared with
+ * the switch based evaluation.
+ *
+ * usage: kernel-bench
+ *
+ * *********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Logic.h"
+#include "Helper.h"
+
+#define KERNEL_TELEGRAMS 20000
+#define KERNEL_LOOPS_PER_TELEGRAM 8 // input conversion, logic and output pass several pipeline stages
+#define KERNEL_LOOPS_STARTUP 10
+#define KERNEL_BATCH_ROUNDS 2000
+#define KERNEL_BATCH_CHANGES 16 // max channels changed in one round
+#define KERNEL_STARTUP_DELAY 3  // max startup delay of delayed channels in s
+#define KERNEL_REPEAT 2000
+
+Logic gLogic;
+
+// simple deterministic random numbers, so each run has the same channels and inputs
+static uint32_t sRandom = 0x12345678;
+
+static uint32_t nextRandom(uint32_t iRange)
+{
+    sRandom = sRandom * 1103515245 + 12345;
+    return (sRandom >> 8) % iRange;
+}
+
+// expected state of a channel, maintained independently of logic module
+struct sKernelChannel
+{
+    uint8_t validActiveIO;
+    uint8_t currentIn; // also contains previous gate state
+};
+
+static sKernelChannel sModel[COUNT_LOG_CHANNEL];
+static uint8_t sBatchChannels[COUNT_LOG_CHANNEL];
+static uint8_t sNumBatchChannels = 0;
+
+// output telegrams received since last check
+static uint16_t sOutputCount[COUNT_LOG_CHANNEL];
+static bool sOutputValue[COUNT_LOG_CHANNEL];
+static uint32_t sErrors = 0;
+
+static uint32_t channelParam(uint8_t iChannel, uint16_t iParam)
+{
+    return LOG_ParamBlockOffset + iChannel * LOG_ParamBlockSize + iParam;
+}
+
+static uint8_t channelByte(uint8_t iChannel, uint16_t iParam)
+{
+    return knx.paramByte(channelParam(iChannel, iParam));
+}
+
+static uint16_t channelKo(uint8_t iChannel, uint8_t iIOIndex)
+{
+    return LOG_KoOffset + iChannel * LOG_KoBlockSize + iIOIndex - 1;
+}
+
+static bool isBatchChannel(uint8_t iChannel)
+{
+    uint8_t lLogic = (channelByte(iChannel, LOG_fCalculate) & LOG_fDisableMask) ? 0 : channelByte(iChannel, LOG_fLogic);
+    return (lLogic == VAL_Logic_And || lLogic == VAL_Logic_Or || lLogic == VAL_Logic_ExOr);
+}
+
+// logic evaluation of processLogic() with switch, as it was before kernels and batch evaluation
+static bool evaluateSwitch(uint8_t iChannel, uint8_t iValidActiveIO, uint8_t &cCurrentIn, bool &cValidOutput, bool &cNewOutput)
+{
+    uint8_t lValidInputs = iValidActiveIO & BIT_INPUT_MASK;
+    uint8_t lActiveInputs = (iValidActiveIO >> 4) & BIT_INPUT_MASK;
+    uint8_t lCurrentInputs = cCurrentIn & lValidInputs;
+    cNewOutput = false;
+    cValidOutput = false;
+    if ((channelByte(iChannel, LOG_fCalculate) & LOG_fCalculateMask) != 0 && lValidInputs != lActiveInputs)
+        return false;
+    uint8_t lLogic = (channelByte(iChannel, LOG_fDisable) & LOG_fDisableMask) ? 0 : channelByte(iChannel, LOG_fLogic);
+    uint8_t lOnes = 0;
+    switch (lLogic)
+    {
+        case VAL_Logic_And:
+            cNewOutput = (lCurrentInputs == lActiveInputs);
+            cValidOutput = true;
+            break;
+        case VAL_Logic_Or:
+            cNewOutput = (lCurrentInputs > 0);
+            cValidOutput = true;
+            break;
+        case VAL_Logic_ExOr:
+            for (size_t lBit = 1; lBit < BIT_INPUT_MASK; lBit <<= 1)
+                lOnes += (lCurrentInputs & lBit) > 0;
+            cNewOutput = (lOnes % 2 == 1);
+            cValidOutput = true;
+            break;
+        case VAL_Logic_Gate:
+            {
+                bool lGate = false;
+                bool lPreviousGate = false;
+                if (lValidInputs & (BIT_EXT_INPUT_2 | BIT_INT_INPUT_2))
+                {
+                    lGate = (lCurrentInputs & (BIT_EXT_INPUT_2 | BIT_INT_INPUT_2));
+                    lPreviousGate = cCurrentIn & BIT_PREVIOUS_GATE;
+                    cCurrentIn &= ~BIT_PREVIOUS_GATE;
+                    if (lGate)
+                        cCurrentIn |= BIT_PREVIOUS_GATE;
+                }
+                uint8_t lGateState = 2 * lPreviousGate + lGate;
+                uint8_t lGateTrigger = 0;
+                switch (lGateState)
+                {
+                    case VAL_Gate_Closed_Open:
+                        lGateTrigger = LOG_fTriggerGateOpen;
+                    case VAL_Gate_Open_Close:
+                        {
+                            if (lGateTrigger == 0)
+                                lGateTrigger = LOG_fTriggerGateClose;
+                            uint8_t lOnGateTrigger = channelByte(iChannel, lGateTrigger) & 3;
+                            cValidOutput = true;
+                            switch (lOnGateTrigger)
+                            {
+                                case VAL_Gate_Send_Off:
+                                    cNewOutput = false;
+                                    break;
+                                case VAL_Gate_Send_On:
+                                    cNewOutput = true;
+                                    break;
+                                case VAL_Gate_Send_Input:
+                                    cNewOutput = (lCurrentInputs & (BIT_EXT_INPUT_1 | BIT_INT_INPUT_1));
+                                    break;
+                                default:
+                                    cValidOutput = false;
+                                    break;
+                            }
+                        }
+                        break;
+                    case VAL_Gate_Open_Open:
+                        cNewOutput = (lCurrentInputs & (BIT_EXT_INPUT_1 | BIT_INT_INPUT_1));
+                        cValidOutput = true;
+                        break;
+                    default:
+                        cValidOutput = false;
+                        break;
+                }
+            }
+            break;
+        case VAL_Logic_Timer:
+            cNewOutput = (lCurrentInputs & BIT_EXT_INPUT_2);
+            cValidOutput = true;
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+// random channels, output is sent on each input telegram, if logic result is valid
+static void setupParams()
+{
+    static const uint8_t cLogics[] = {VAL_Logic_And, VAL_Logic_Or, VAL_Logic_ExOr, VAL_Logic_Gate, VAL_Logic_Gate, 0, VAL_Logic_Timer + 1};
+    knx.setParamByte(LOG_NumChannels, COUNT_LOG_CHANNEL);
+    knx.setParamInt(LOG_StartupDelay, 0);
+    for (uint8_t lChannel = 0; lChannel < COUNT_LOG_CHANNEL; lChannel++)
+    {
+        knx.setParamByte(channelParam(lChannel, LOG_fLogic), cLogics[nextRandom(sizeof(cLogics))]);
+        knx.setParamByte(channelParam(lChannel, LOG_fCalculate), nextRandom(4) | ((nextRandom(8) == 0) ? LOG_fDisableMask : 0));
+        knx.setParamByte(channelParam(lChannel, LOG_fTrigger), BIT_INPUT_MASK);
+        knx.setParamByte(channelParam(lChannel, LOG_fTriggerGateClose), nextRandom(4));
+        knx.setParamByte(channelParam(lChannel, LOG_fTriggerGateOpen), nextRandom(4));
+        // external inputs inactive, normal or negated
+        knx.setParamByte(channelParam(lChannel, LOG_fE1), nextRandom(3));
+        knx.setParamByte(channelParam(lChannel, LOG_fE1Dpt), VAL_DPT_1);
+        knx.setParamByte(channelParam(lChannel, LOG_fE2), nextRandom(3));
+        knx.setParamByte(channelParam(lChannel, LOG_fE2Dpt), VAL_DPT_1);
+        // some active internal inputs without source, they stay invalid
+        uint8_t lInternal = 0;
+        if (nextRandom(4) == 0)
+            lInternal |= (1 + nextRandom(2)) << LOG_fI1Shift;
+        if (nextRandom(4) == 0)
+            lInternal |= 1 + nextRandom(2);
+        knx.setParamByte(channelParam(lChannel, LOG_fI1), lInternal);
+        knx.setParamByte(channelParam(lChannel, LOG_fODpt), VAL_DPT_1);
+        knx.setParamByte(channelParam(lChannel, LOG_fOOn), VAL_Out_Constant);
+        knx.setParamByte(channelParam(lChannel, LOG_fOOnDpt1), 1);
+        knx.setParamByte(channelParam(lChannel, LOG_fOOff), VAL_Out_Constant);
+        knx.setParamByte(channelParam(lChannel, LOG_fOOffDpt1), 0);
+        // some batch channels start delayed
+        knx.setParamInt(channelParam(lChannel, LOG_fChannelDelay), (isBatchChannel(lChannel) && nextRandom(4) == 0) ? 1 + nextRandom(KERNEL_STARTUP_DELAY) : 0);
+    }
+}
+
+static void setupModel()
+{
+    for (uint8_t lChannel = 0; lChannel < COUNT_LOG_CHANNEL; lChannel++)
+    {
+        uint8_t lActive = 0;
+        if (channelByte(lChannel, LOG_fE1) & BIT_INPUT_MASK)
+            lActive |= BIT_EXT_INPUT_1;
+        if (channelByte(lChannel, LOG_fE2) & BIT_INPUT_MASK)
+            lActive |= BIT_EXT_INPUT_2;
+        if (channelByte(lChannel, LOG_fI1) >> LOG_fI1Shift)
+            lActive |= BIT_INT_INPUT_1;
+        if (channelByte(lChannel, LOG_fI2) & LOG_fI2Mask)
+            lActive |= BIT_INT_INPUT_2;
+        sModel[lChannel].validActiveIO = lActive << 4;
+        sModel[lChannel].currentIn = 0;
+        if (isBatchChannel(lChannel))
+            sBatchChannels[sNumBatchChannels++] = lChannel;
+    }
+}
+
+static void onKoWritten(GroupObject &iKo)
+{
+    uint16_t lKoNumber = iKo.asap();
+    if (lKoNumber < LOG_KoOffset || (lKoNumber - LOG_KoOffset) % LOG_KoBlockSize != IO_Output - 1)
+        return;
+    uint8_t lChannel = (lKoNumber - LOG_KoOffset) / LOG_KoBlockSize;
+    sOutputCount[lChannel]++;
+    sOutputValue[lChannel] = iKo.valueRef()[0];
+}
+
+static void processLoops(uint8_t iCount)
+{
+    for (uint8_t lLoop = 0; lLoop < iCount; lLoop++)
+        gLogic.loop();
+}
+
+// evaluates model of channel and compares expected with received output telegrams
+static void checkChannel(uint8_t iChannel, const char *iEvent)
+{
+    sKernelChannel &lModel = sModel[iChannel];
+    bool lValid, lOutput;
+    uint8_t lCurrentIn = lModel.currentIn;
+    bool lEvaluated = evaluateSwitch(iChannel, lModel.validActiveIO, lModel.currentIn, lValid, lOutput);
+    uint16_t lExpected = (lEvaluated && lValid) ? 1 : 0;
+    if (sOutputCount[iChannel] != lExpected || (lExpected > 0 && sOutputValue[iChannel] != lOutput))
+    {
+        if (sErrors < 10)
+            printf("channel %d (logic %d, calculate %02X) %s, validActiveIO %02X, currentIn %02X: expected %d telegrams with %d, received %d with %d\n",
+                   iChannel + 1, channelByte(iChannel, LOG_fLogic), channelByte(iChannel, LOG_fCalculate), iEvent, lModel.validActiveIO, lCurrentIn,
+                   lExpected, lOutput, sOutputCount[iChannel], sOutputValue[iChannel]);
+        sErrors++;
+    }
+    sOutputCount[iChannel] = 0;
+}
+
+// no channel may send without an input event
+static void checkSilence(const char *iEvent)
+{
+    for (uint8_t lChannel = 0; lChannel < COUNT_LOG_CHANNEL; lChannel++)
+        if (sOutputCount[lChannel] > 0)
+        {
+            if (sErrors < 10)
+                printf("channel %d sent %d telegrams %s\n", lChannel + 1, sOutputCount[lChannel], iEvent);
+            sErrors++;
+            sOutputCount[lChannel] = 0;
+        }
+}
+
+// random state of all four inputs of a batch channel, set like startLogic() does,
+// just valid bits of active inputs are set, current bits of invalid inputs are random
+static void changeBatchChannel(uint8_t iChannel, bool iTrigger)
+{
+    sKernelChannel &lModel = sModel[iChannel];
+    uint8_t lValid = nextRandom(16) & (lModel.validActiveIO >> 4);
+    uint8_t lCurrent = nextRandom(16);
+    lModel.validActiveIO = (lModel.validActiveIO & ~BIT_INPUT_MASK) | lValid;
+    lModel.currentIn = (lModel.currentIn & ~BIT_INPUT_MASK) | lCurrent;
+    sChannelState *lState = LogicChannel::sState;
+    lState->validActiveIO[iChannel] = (lState->validActiveIO[iChannel] & ~BIT_INPUT_MASK) | lValid;
+    lState->currentIn[iChannel] = (lState->currentIn[iChannel] & ~BIT_INPUT_MASK) | lCurrent;
+    if (iTrigger)
+        lState->triggerIO[iChannel] |= 1 + nextRandom(BIT_INPUT_MASK);
+    gLogic.updateLogicBatch(iChannel, lState->currentIn[iChannel], lState->validActiveIO[iChannel]);
+}
+
+static bool isRunning(uint8_t iChannel)
+{
+    return LogicChannel::sState->currentPipeline[iChannel] & PIP_RUNNING;
+}
+
+// batch channels with startup delay are changed before they run
+static void processDelayedChannels()
+{
+    bool lWaiting[COUNT_LOG_CHANNEL] = {false};
+    for (uint8_t lIndex = 0; lIndex < sNumBatchChannels; lIndex++)
+    {
+        uint8_t lChannel = sBatchChannels[lIndex];
+        lWaiting[lChannel] = !isRunning(lChannel);
+        if (lWaiting[lChannel])
+            changeBatchChannel(lChannel, true);
+    }
+    processLoops(KERNEL_LOOPS_PER_TELEGRAM);
+    checkSilence("before end of startup delay");
+    // channels, which did not start yet, are changed again, evaluation of
+    // last state has to happen when each channel starts
+    for (uint8_t lStep = 0; lStep <= 2 * KERNEL_STARTUP_DELAY; lStep++)
+    {
+        for (uint8_t lIndex = 0; lIndex < sNumBatchChannels; lIndex++)
+            if (lWaiting[sBatchChannels[lIndex]] && nextRandom(2))
+                changeBatchChannel(sBatchChannels[lIndex], true);
+        hostAdvanceMillis(500);
+        processLoops(KERNEL_LOOPS_STARTUP);
+        for (uint8_t lChannel = 0; lChannel < COUNT_LOG_CHANNEL; lChannel++)
+            if (lWaiting[lChannel] && isRunning(lChannel))
+            {
+                checkChannel(lChannel, "after startup delay");
+                lWaiting[lChannel] = false;
+            }
+        checkSilence("during startup delay");
+    }
+    for (uint8_t lChannel = 0; lChannel < COUNT_LOG_CHANNEL; lChannel++)
+        if (lWaiting[lChannel])
+        {
+            printf("channel %d did not start\n", lChannel + 1);
+            sErrors++;
+        }
+}
+
+// several batch channels are changed before each loop, some of them more than once
+static void processBatchChanges()
+{
+    for (uint16_t lRound = 0; lRound < KERNEL_BATCH_ROUNDS; lRound++)
+    {
+        bool lChanged[COUNT_LOG_CHANNEL] = {false};
+        uint8_t lChanges = 1 + nextRandom(KERNEL_BATCH_CHANGES);
+        for (uint8_t lChange = 0; lChange < lChanges; lChange++)
+        {
+            uint8_t lChannel = sBatchChannels[nextRandom(sNumBatchChannels)];
+            changeBatchChannel(lChannel, true);
+            lChanged[lChannel] = true;
+        }
+        processLoops(KERNEL_LOOPS_PER_TELEGRAM);
+        for (uint8_t lChannel = 0; lChannel < COUNT_LOG_CHANNEL; lChannel++)
+            if (lChanged[lChannel])
+                checkChannel(lChannel, "after batch change");
+        checkSilence("without batch change");
+    }
+}
+
+// random telegrams on external inputs, returns time per telegram in us for batch and pipeline channels
+static void processTelegrams(double &cBatch, double &cPipeline)
+{
+    clock_t lTime[2] = {0, 0};
+    uint32_t lCount[2] = {0, 0};
+    for (uint32_t lTelegram = 0; lTelegram < KERNEL_TELEGRAMS; lTelegram++)
+    {
+        uint8_t lChannel = nextRandom(COUNT_LOG_CHANNEL);
+        uint8_t lIOIndex = IO_Input1 + nextRandom(2);
+        bool lValue = nextRandom(2);
+        bool lBatch = isBatchChannel(lChannel);
+        clock_t lStart = clock();
+        knx.getGroupObject(channelKo(lChannel, lIOIndex)).receive(lValue, getDPT(VAL_DPT_1));
+        processLoops(KERNEL_LOOPS_PER_TELEGRAM);
+        lTime[lBatch] += clock() - lStart;
+        lCount[lBatch]++;
+
+        // telegrams on inactive inputs are ignored
+        uint8_t lMode = channelByte(lChannel, (lIOIndex == IO_Input1) ? LOG_fE1 : LOG_fE2) & BIT_INPUT_MASK;
+        if (lMode > 0)
+        {
+            sKernelChannel &lModel = sModel[lChannel];
+            uint8_t lBit = (lIOIndex == IO_Input1) ? BIT_EXT_INPUT_1 : BIT_EXT_INPUT_2;
+            if (lMode == 2)
+                lValue = !lValue;
+            lModel.currentIn = (lModel.currentIn & ~lBit) | (lValue ? lBit : 0);
+            lModel.validActiveIO |= lBit;
+            checkChannel(lChannel, "after input telegram");
+        }
+        checkSilence("without input");
+    }
+    cBatch = (lCount[1] > 0) ? (double)lTime[1] / CLOCKS_PER_SEC * 1e6 / lCount[1] : 0.0;
+    cPipeline = (lCount[0] > 0) ? (double)lTime[0] / CLOCKS_PER_SEC * 1e6 / lCount[0] : 0.0;
+}
+
+// time per switch based evaluation in ns over the current state of all batch channels
+static double measureSwitch()
+{
+    volatile uint32_t lSum = 0; // keeps results alive
+    clock_t lStart = clock();
+    for (uint16_t lRepeat = 0; lRepeat < KERNEL_REPEAT; lRepeat++)
+        for (uint8_t lIndex = 0; lIndex < sNumBatchChannels; lIndex++)
+        {
+            uint8_t lChannel = sBatchChannels[lIndex];
+            bool lValid, lOutput;
+            uint8_t lCurrentIn = sModel[lChannel].currentIn;
+            bool lEvaluated = evaluateSwitch(lChannel, sModel[lChannel].validActiveIO, lCurrentIn, lValid, lOutput);
+            lSum += lEvaluated + 2 * lValid + 4 * lOutput;
+        }
+    return (double)(clock() - lStart) / CLOCKS_PER_SEC * 1e9 / ((double)KERNEL_REPEAT * sNumBatchChannels);
+}
+
+// time per channel in ns of batch evaluation including updateLogicBatch(), all batch channels
+// are changed before each loop, without trigger no output is sent, time of a loop without
+// changes is subtracted
+static double measureBatch()
+{
+    clock_t lStart = clock();
+    for (uint16_t lRepeat = 0; lRepeat < KERNEL_REPEAT; lRepeat++)
+        gLogic.loop();
+    clock_t lIdle = clock() - lStart;
+    lStart = clock();
+    for (uint16_t lRepeat = 0; lRepeat < KERNEL_REPEAT; lRepeat++)
+    {
+        for (uint8_t lIndex = 0; lIndex < sNumBatchChannels; lIndex++)
+            changeBatchChannel(sBatchChannels[lIndex], false);
+        gLogic.loop();
+    }
+    clock_t lBatch = clock() - lStart - lIdle;
+    return (double)lBatch / CLOCKS_PER_SEC * 1e9 / ((double)KERNEL_REPEAT * sNumBatchChannels);
+}
+
+int main(int argc, char **argv)
+{
+    setupParams();
+    setupModel();
+    gHostKoWritten = onKoWritten;
+    hostSetMillis(1);
+    gLogic.setup(false);
+    processLoops(KERNEL_LOOPS_STARTUP);
+    checkSilence("during startup");
+    processDelayedChannels();
+
+    double lBatch, lPipeline;
+    processTelegrams(lBatch, lPipeline);
+    processBatchChanges();
+    double lSwitch = measureSwitch();
+    double lBatchEvaluation = measureBatch();
+    checkSilence("without trigger");
+    printf("%u telegrams and %u batch rounds checked, %u different, telegram to output: batch %.2f us, pipeline %.2f us\n",
+           KERNEL_TELEGRAMS, KERNEL_BATCH_ROUNDS, sErrors, lBatch, lPipeline);
+    printf("evaluation of %d AND/OR/EXOR channels: batch with update and finishLogic %.2f ns, switch alone %.2f ns per channel\n",
+           sNumBatchChannels, lBatchEvaluation, lSwitch);
+    return (sErrors == 0) ? 0 : 1;
+}
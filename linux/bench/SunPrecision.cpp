@@ -0,0 +1,165 @@
+/***********************************
+ *
+ * Compares sunrise/sunset calculation with double and single precision
+ * (SUN_SINGLE_PRECISION) on host.
+ *
+ * This file is compiled twice, once for each precision. Each binary dumps
+ * sunrise and sunset in minutes of day (UT, rounded like the sun table)
+ * for each day of 2000 - 2099 at several latitudes including polar ones
+ * and reports the time per calculation. The compare step fails, if any
+ * result differs by more than SUN_MAX_DIFF_MINUTES.
+ *
+ * usage: sun-precision-double|single dump <file>
+ *        sun-precision-double compare <double file> <single file>
+ *
+ * *********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Timer.h"
+
+#define SUN_FIRST_YEAR 2000
+#define SUN_LAST_YEAR 2099
+#define SUN_MAX_DIFF_MINUTES 1
+
+struct sSunLocation
+{
+    const char *name;
+    float latitude;
+    float longitude;
+};
+
+static const sSunLocation cSunLocations[] = {
+    {"quito", -0.18f, -78.47f},
+    {"sydney", -33.87f, 151.21f},
+    {"ushuaia", -54.80f, -68.30f},
+    {"lisbon", 38.72f, -9.14f},
+    {"frankfurt", 50.11f, 8.68f},
+    {"helsinki", 60.17f, 24.94f},
+    {"rovaniemi", 66.50f, 25.73f}, // polar circle
+    {"tromso", 69.65f, 18.96f},    // polar night and midnight sun
+    {"longyearbyen", 78.22f, 15.65f},
+    {"mcmurdo", -77.85f, 166.67f}};
+
+#define SUN_NUM_LOCATIONS (sizeof(cSunLocations) / sizeof(sSunLocation))
+
+// gives access to protected sun calculation of timer
+class SunPrecision : public Timer
+{
+  public:
+    SunPrecision() : Timer() {}
+
+    int16_t sunMinutes(uint16_t iYear, uint8_t iMonth, uint8_t iDay, const sSunLocation &iLocation, int16_t &cSet)
+    {
+        sunfloat_t lRise, lSet;
+        sunRiseSet(iYear, iMonth, iDay, iLocation.longitude, iLocation.latitude, SUN_F(35.0 / 60.0), 1, &lRise, &lSet);
+        cSet = normalizeMinuteOfDay((int16_t)SUN_ROUND(lSet * SUN_F(60.0)));
+        return normalizeMinuteOfDay((int16_t)SUN_ROUND(lRise * SUN_F(60.0)));
+    }
+};
+
+static bool isLeap(uint16_t iYear)
+{
+    return (iYear % 4 == 0 && iYear % 100 != 0) || iYear % 400 == 0;
+}
+
+static uint8_t daysInMonth(uint16_t iYear, uint8_t iMonth)
+{
+    static const uint8_t cDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (iMonth == 2 && isLeap(iYear)) ? 29 : cDays[iMonth - 1];
+}
+
+static int dump(const char *iFileName)
+{
+    FILE *lFile = fopen(iFileName, "w");
+    if (lFile == nullptr)
+    {
+        perror(iFileName);
+        return 2;
+    }
+    SunPrecision lSun;
+    uint32_t lCount = 0;
+    double lSeconds = 0;
+    int16_t lRise[366];
+    int16_t lSet[366];
+    for (uint8_t lLocation = 0; lLocation < SUN_NUM_LOCATIONS; lLocation++)
+        for (uint16_t lYear = SUN_FIRST_YEAR; lYear <= SUN_LAST_YEAR; lYear++)
+        {
+            // just calculation is measured, output is done per year afterwards
+            uint16_t lDays = 0;
+            clock_t lStart = clock();
+            for (uint8_t lMonth = 1; lMonth <= 12; lMonth++)
+                for (uint8_t lDay = 1; lDay <= daysInMonth(lYear, lMonth); lDay++, lDays++)
+                    lRise[lDays] = lSun.sunMinutes(lYear, lMonth, lDay, cSunLocations[lLocation], lSet[lDays]);
+            lSeconds += (double)(clock() - lStart) / CLOCKS_PER_SEC;
+            lDays = 0;
+            for (uint8_t lMonth = 1; lMonth <= 12; lMonth++)
+                for (uint8_t lDay = 1; lDay <= daysInMonth(lYear, lMonth); lDay++, lDays++)
+                    fprintf(lFile, "%s %04d-%02d-%02d %4d %4d\n", cSunLocations[lLocation].name, lYear, lMonth, lDay, lRise[lDays], lSet[lDays]);
+            lCount += lDays;
+        }
+    fclose(lFile);
+    printf("%s precision: %u days, %.3f us per sunrise/sunset calculation\n",
+           (sizeof(sunfloat_t) == sizeof(float)) ? "single" : "double", lCount, lSeconds * 1e6 / lCount);
+    return 0;
+}
+
+// difference of two minutes of day, a result around midnight may be on the other side of 0
+static int16_t minuteDiff(int16_t iMinute1, int16_t iMinute2)
+{
+    int16_t lDiff = abs(iMinute1 - iMinute2);
+    return (lDiff > 720) ? 1440 - lDiff : lDiff;
+}
+
+static int compare(const char *iDoubleFile, const char *iSingleFile)
+{
+    FILE *lDouble = fopen(iDoubleFile, "r");
+    FILE *lSingle = fopen(iSingleFile, "r");
+    if (lDouble == nullptr || lSingle == nullptr)
+    {
+        perror("open dump");
+        return 2;
+    }
+    char lNameD[32], lDateD[16], lNameS[32], lDateS[16];
+    int lRiseD, lSetD, lRiseS, lSetS;
+    uint32_t lCount = 0;
+    uint32_t lDiffCount[SUN_MAX_DIFF_MINUTES + 2] = {0}; // last entry counts all larger differences
+    int16_t lMaxDiff = 0;
+    while (fscanf(lDouble, "%31s %15s %d %d", lNameD, lDateD, &lRiseD, &lSetD) == 4)
+    {
+        if (fscanf(lSingle, "%31s %15s %d %d", lNameS, lDateS, &lRiseS, &lSetS) != 4 || strcmp(lNameD, lNameS) || strcmp(lDateD, lDateS))
+        {
+            fprintf(stderr, "dumps do not match at %s %s\n", lNameD, lDateD);
+            return 1;
+        }
+        int16_t lDiff = minuteDiff(lRiseD, lRiseS);
+        int16_t lDiffSet = minuteDiff(lSetD, lSetS);
+        if (lDiffSet > lDiff)
+            lDiff = lDiffSet;
+        if (lDiff > SUN_MAX_DIFF_MINUTES)
+            printf("%s %s: double %4d %4d, single %4d %4d\n", lNameD, lDateD, lRiseD, lSetD, lRiseS, lSetS);
+        if (lDiff > lMaxDiff)
+            lMaxDiff = lDiff;
+        lDiffCount[(lDiff > SUN_MAX_DIFF_MINUTES) ? SUN_MAX_DIFF_MINUTES + 1 : lDiff]++;
+        lCount++;
+    }
+    fclose(lDouble);
+    fclose(lSingle);
+    printf("%u days compared, max difference %d min", lCount, lMaxDiff);
+    for (uint8_t lDiff = 0; lDiff <= SUN_MAX_DIFF_MINUTES; lDiff++)
+        printf(", %d min: %u", lDiff, lDiffCount[lDiff]);
+    printf("\n");
+    return (lCount > 0 && lMaxDiff <= SUN_MAX_DIFF_MINUTES) ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 3 && strcmp(argv[1], "dump") == 0)
+        return dump(argv[2]);
+    if (argc == 4 && strcmp(argv[1], "compare") == 0)
+        return compare(argv[2], argv[3]);
+    fprintf(stderr, "usage: %s dump <file> | compare <double file> <single file>\n", argv[0]);
+    return 2;
+}
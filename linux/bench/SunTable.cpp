@@ -0,0 +1,206 @@
+/***********************************
+ *
+ * Sun table benchmark and accuracy check on host.
+ *
+ * For several locations and years each day of the sun table is compared
+ * with the live calculation by sunRiseSet(), sunrise and sunset of
+ * calculateSunriseSunset() have to be within one day (0:00 - 23:59), also
+ * for locations, whose timezone shifts the result to previous or next day.
+ * Afterwards table lookup and live calculation are timed for all days of a
+ * year, repeated like TimerRestore replays days.
+ *
+ * usage: sun-table
+ *
+ * *********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Timer.h"
+
+#define SUN_TABLE_FIRST_YEAR 2020
+#define SUN_TABLE_LAST_YEAR 2030
+#define SUN_TABLE_REPEAT 20
+
+struct sSunTableLocation
+{
+    const char *name;
+    float latitude;
+    float longitude;
+    int8_t timezone;
+    bool useSummertime;
+};
+
+static const sSunTableLocation cSunTableLocations[] = {
+    {"frankfurt", 50.11f, 8.68f, 1, true},
+    {"tromso", 69.65f, 18.96f, 1, true},    // polar night and midnight sun
+    {"longyearbyen", 78.22f, 15.65f, 1, true},
+    {"lisbon", 38.72f, -9.14f, 0, true},
+    {"moscow", 55.75f, 37.62f, 3, false},
+    {"apia", -13.83f, -171.76f, 3, false},  // timezone shifts sunset to next day
+    {"suva", -18.14f, 178.44f, 0, false}};  // UT of sunrise is on previous day
+
+#define SUN_TABLE_NUM_LOCATIONS (sizeof(cSunTableLocations) / sizeof(sSunTableLocation))
+
+// gives access to sun table and live calculation of timer
+class SunTable : public Timer
+{
+  public:
+    SunTable() : Timer() {}
+
+    void setLocation(const sSunTableLocation &iLocation)
+    {
+        setup(iLocation.longitude, iLocation.latitude, iLocation.timezone, iLocation.useSummertime, 0);
+    }
+
+    // sets date, just fields used by sun calculation are set, so no mktime() is needed in loops
+    void setDate(uint16_t iYear, uint8_t iMonth, uint8_t iDay, uint16_t iDayOfYear)
+    {
+        mNow.tm_year = iYear - 1900;
+        mNow.tm_mon = iMonth - 1;
+        mNow.tm_mday = iDay;
+        mNow.tm_yday = iDayOfYear;
+    }
+
+    void startYear()
+    {
+        calculateSummertime();
+    }
+
+    // sunrise/sunset of current day like it was calculated before the sun table was introduced
+    void calculateLive(int16_t &cRise, int16_t &cSet)
+    {
+        sunfloat_t lRise, lSet;
+        sunRiseSet(getYear(), getMonth(), getDay(), mLongitude, mLatitude, SUN_F(35.0 / 60.0), 1, &lRise, &lSet);
+        cRise = normalizeMinuteOfDay((int16_t)SUN_ROUND(lRise * SUN_F(60.0)) + mTimezone * 60);
+        cSet = normalizeMinuteOfDay((int16_t)SUN_ROUND(lSet * SUN_F(60.0)) + mTimezone * 60);
+    }
+
+    int16_t *lookup()
+    {
+        return getSunTableEntry();
+    }
+
+    void calculate()
+    {
+        calculateSunriseSunset();
+    }
+};
+
+static bool isLeap(uint16_t iYear)
+{
+    return (iYear % 4 == 0 && iYear % 100 != 0) || iYear % 400 == 0;
+}
+
+static uint8_t daysInMonth(uint16_t iYear, uint8_t iMonth)
+{
+    static const uint8_t cDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (iMonth == 2 && isLeap(iYear)) ? 29 : cDays[iMonth - 1];
+}
+
+// month and day for each day of year
+static uint16_t fillCalendar(uint16_t iYear, uint8_t *cMonth, uint8_t *cDay)
+{
+    uint16_t lDays = 0;
+    for (uint8_t lMonth = 1; lMonth <= 12; lMonth++)
+        for (uint8_t lDay = 1; lDay <= daysInMonth(iYear, lMonth); lDay++, lDays++)
+        {
+            cMonth[lDays] = lMonth;
+            cDay[lDays] = lDay;
+        }
+    return lDays;
+}
+
+// returns number of wrong days
+static uint32_t checkAccuracy(SunTable &iSun, const sSunTableLocation &iLocation, uint32_t &cDays)
+{
+    uint32_t lErrors = 0;
+    uint8_t lMonth[366];
+    uint8_t lDay[366];
+    iSun.setLocation(iLocation);
+    for (uint16_t lYear = SUN_TABLE_FIRST_YEAR; lYear <= SUN_TABLE_LAST_YEAR; lYear++)
+    {
+        uint16_t lDays = fillCalendar(lYear, lMonth, lDay);
+        iSun.setDate(lYear, 1, 1, 0);
+        iSun.startYear();
+        for (uint16_t lIndex = 0; lIndex < lDays; lIndex++)
+        {
+            iSun.setDate(lYear, lMonth[lIndex], lDay[lIndex], lIndex);
+            int16_t lRise, lSet;
+            iSun.calculateLive(lRise, lSet);
+            int16_t *lEntry = iSun.lookup();
+            iSun.calculate();
+            sTime *lSunrise = iSun.getSunInfo(SUN_SUNRISE);
+            sTime *lSunset = iSun.getSunInfo(SUN_SUNSET);
+            bool lInDay = lSunrise->hour < 24 && lSunrise->minute < 60 && lSunset->hour < 24 && lSunset->minute < 60;
+            if (lEntry[SUN_SUNRISE] != lRise || lEntry[SUN_SUNSET] != lSet || !lInDay)
+            {
+                if (lErrors < 10)
+                    printf("%s %04d-%02d-%02d: table %d %d, live %d %d, sunrise %02d:%02d, sunset %02d:%02d\n", iLocation.name, lYear, lMonth[lIndex], lDay[lIndex],
+                           lEntry[SUN_SUNRISE], lEntry[SUN_SUNSET], lRise, lSet, lSunrise->hour, lSunrise->minute, lSunset->hour, lSunset->minute);
+                lErrors++;
+            }
+            cDays++;
+        }
+    }
+    return lErrors;
+}
+
+// time per day in us for live calculation and for table lookup, the first table pass includes filling the table
+static void benchmark(SunTable &iSun, const sSunTableLocation &iLocation, double &cLive, double &cTable)
+{
+    uint8_t lMonth[366];
+    uint8_t lDay[366];
+    uint16_t lDays = fillCalendar(SUN_TABLE_LAST_YEAR, lMonth, lDay);
+    volatile int32_t lSum = 0; // keeps results alive
+    iSun.setLocation(iLocation);
+    iSun.setDate(SUN_TABLE_LAST_YEAR, 1, 1, 0);
+    iSun.startYear();
+
+    clock_t lStart = clock();
+    for (uint8_t lRepeat = 0; lRepeat < SUN_TABLE_REPEAT; lRepeat++)
+        for (uint16_t lIndex = 0; lIndex < lDays; lIndex++)
+        {
+            int16_t lRise, lSet;
+            iSun.setDate(SUN_TABLE_LAST_YEAR, lMonth[lIndex], lDay[lIndex], lIndex);
+            iSun.calculateLive(lRise, lSet);
+            lSum += lRise + lSet;
+        }
+    cLive = (double)(clock() - lStart) / CLOCKS_PER_SEC * 1e6 / (SUN_TABLE_REPEAT * lDays);
+
+    // other year invalidates the table, so first pass has to calculate it again
+    iSun.setDate(SUN_TABLE_FIRST_YEAR, 1, 1, 0);
+    iSun.lookup();
+    lStart = clock();
+    for (uint8_t lRepeat = 0; lRepeat < SUN_TABLE_REPEAT; lRepeat++)
+        for (uint16_t lIndex = 0; lIndex < lDays; lIndex++)
+        {
+            iSun.setDate(SUN_TABLE_LAST_YEAR, lMonth[lIndex], lDay[lIndex], lIndex);
+            iSun.calculate();
+            lSum += iSun.getSunInfo(SUN_SUNRISE)->minute;
+        }
+    cTable = (double)(clock() - lStart) / CLOCKS_PER_SEC * 1e6 / (SUN_TABLE_REPEAT * lDays);
+}
+
+int main(int argc, char **argv)
+{
+    // summertime calculation uses mktime() on local calendar values
+    setenv("TZ", "UTC", 1);
+    tzset();
+
+    SunTable lSun;
+    uint32_t lErrors = 0;
+    for (uint8_t lLocation = 0; lLocation < SUN_TABLE_NUM_LOCATIONS; lLocation++)
+    {
+        uint32_t lDays = 0;
+        double lLive, lTable;
+        const sSunTableLocation &lCurrent = cSunTableLocations[lLocation];
+        uint32_t lLocationErrors = checkAccuracy(lSun, lCurrent, lDays);
+        benchmark(lSun, lCurrent, lLive, lTable);
+        printf("%-12s %u days checked, %u wrong, live %.3f us/day, table %.3f us/day (%.0fx)\n",
+               lCurrent.name, lDays, lLocationErrors, lLive, lTable, (lTable > 0) ? lLive / lTable : 0.0);
+        lErrors += lLocationErrors;
+    }
+    return (lErrors == 0) ? 0 : 1;
+}
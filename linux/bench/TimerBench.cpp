@@ -0,0 +1,352 @@
+/***********************************
+ *
+ * Timer benchmark and regression run on host.
+ *
+ * 99 timer channels with a deterministic mix of daily, yearly and sun
+ * dependent timers are simulated for one year (plus the change to next year)
+ * at one location. The clock is driven by Timer::processClockStep() and after
+ * each minute Logic::loop() processes all due channels, like on the device.
+ * Each output telegram is written to the schedule file, telegrams of the same
+ * minute are ordered by channel, so the file does not depend on evaluation
+ * order and can be diffed between revisions. Reported are the channel minute
+ * evaluations per second and the CPU time per simulated day.
+ *
+ * This file is also compiled with LOGIC_TIMER_SCAN, then Logic evaluates all
+ * timer channels each minute instead of just the due ones from timer heap.
+ * The compare step fails, if the schedule of the timer heap differs from
+ * this reference schedule.
+ *
+ * usage: timer-bench <location> <schedule file>
+ *        timer-bench compare <schedule file> <reference schedule file>
+ *
+ * *********************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Logic.h"
+#include "Helper.h"
+
+struct sLocation
+{
+    const char *name;
+    float latitude;
+    float longitude;
+    uint8_t timezone;
+    bool useSummertime;
+};
+
+static const sLocation cLocations[] = {
+    {"frankfurt", 50.11f, 8.68f, 1, true},
+    {"tromso", 69.65f, 18.96f, 1, true}, // polar night and midnight sun
+    {"lisbon", 38.72f, -9.14f, 0, true},
+    {"helsinki", 60.17f, 24.94f, 2, true},
+    {"moscow", 55.75f, 37.62f, 3, false}};
+
+#define BENCH_YEAR 2021
+#define BENCH_DAYS 366 // whole year and first day of next year
+#define BENCH_LOOPS_PER_MINUTE 6 // a timer switch passes 4 pipeline stages, 2 passes spare
+#define BENCH_LOOPS_STARTUP 10   // startup and timer restore need more pipeline passes
+#define BENCH_MAX_SWITCHES_PER_MINUTE (4 * COUNT_LOG_CHANNEL)
+#define BENCH_MAX_LINE 64
+
+struct sSwitch
+{
+    uint8_t channel;
+    uint8_t value;
+};
+
+Logic gLogic;
+static FILE *sSchedule = nullptr;
+static uint32_t sSwitchCount = 0;
+static sSwitch sMinuteSwitches[BENCH_MAX_SWITCHES_PER_MINUTE];
+static uint16_t sNumMinuteSwitches = 0;
+
+// simple deterministic random numbers, so each run has the same timers
+static uint32_t sRandom = 0x12345678;
+
+static uint32_t nextRandom(uint32_t iRange)
+{
+    sRandom = sRandom * 1103515245 + 12345;
+    return (sRandom >> 8) % iRange;
+}
+
+static uint32_t channelParam(uint8_t iChannel, uint16_t iParam)
+{
+    return LOG_ParamBlockOffset + iChannel * LOG_ParamBlockSize + iParam;
+}
+
+static uint16_t timerBitfield(bool iValue, uint8_t iHour, uint8_t iMinute, uint8_t iWeekday)
+{
+    return (iValue ? 0x8000 : 0) | (iHour << 9) | (iMinute << 3) | (iWeekday & 7);
+}
+
+// daily timer with point in time and sun timers mixed
+static void setupDailyTimer(uint8_t iChannel, bool iSunOnly)
+{
+    uint32_t lFunctions = 0;
+    for (uint8_t lIndex = 0; lIndex < VAL_Tim_DayTimerCount; lIndex++)
+    {
+        uint8_t lFunction = VAL_Tim_Inactive;
+        uint8_t lHour = 0;
+        uint8_t lMinute = 0;
+        uint8_t lChoice = nextRandom(10);
+        if (lChoice < 2 && !iSunOnly)
+            continue;
+        bool lValue = (lIndex & 1) == 0;
+        if (lChoice < 5 && !iSunOnly)
+        {
+            lFunction = VAL_Tim_PointInTime;
+            lHour = (nextRandom(8) == 0) ? VAL_Tim_Every_Hour : nextRandom(24);
+            lMinute = nextRandom(60);
+        }
+        else if (lChoice < 8)
+        {
+            // offset to sunrise or sunset
+            lFunction = VAL_Tim_Sunrise_Plus + nextRandom(2) + 4 * nextRandom(2);
+            lHour = nextRandom(3);
+            lMinute = nextRandom(60);
+        }
+        else
+        {
+            // earliest/latest limit of sunrise or sunset
+            lFunction = VAL_Tim_Sunrise_Earliest + nextRandom(2);
+            bool lSunset = nextRandom(2);
+            if (lSunset)
+                lFunction += 4;
+            lHour = lSunset ? 16 + nextRandom(6) : 5 + nextRandom(4);
+            lMinute = nextRandom(60);
+        }
+        lFunctions |= (uint32_t)lFunction << (28 - lIndex * 4);
+        knx.setParamWord(channelParam(iChannel, LOG_fTd1Value + 2 * lIndex), timerBitfield(lValue, lHour, lMinute, nextRandom(8)));
+    }
+    knx.setParamInt(channelParam(iChannel, LOG_fTd1DuskDawn), lFunctions);
+}
+
+// yearly timer with month, day or weekday settings
+static void setupYearlyTimer(uint8_t iChannel)
+{
+    uint32_t lFunctions = 0;
+    knx.setParamByte(channelParam(iChannel, LOG_fTYearDay), knx.paramByte(channelParam(iChannel, LOG_fTYearDay)) | LOG_fTYearDayMask);
+    for (uint8_t lIndex = 0; lIndex < VAL_Tim_YearTimerCount; lIndex++)
+    {
+        uint8_t lFunction = (nextRandom(3) == 0) ? VAL_Tim_Sunset_Plus + nextRandom(2) : VAL_Tim_PointInTime;
+        uint8_t lDayWeekday;
+        switch (nextRandom(3))
+        {
+            case 0:
+                lDayWeekday = nextRandom(29) << 1; // day of month, 0 = every day
+                break;
+            case 1:
+                lDayWeekday = (nextRandom(127) + 1) << 1 | 1; // set of weekdays
+                break;
+            default:
+                lDayWeekday = 0xFF; // every day
+                break;
+        }
+        lFunctions |= (uint32_t)lFunction << (28 - lIndex * 4);
+        knx.setParamWord(channelParam(iChannel, LOG_fTd1Value + 2 * lIndex), timerBitfield((lIndex & 1) == 0, nextRandom(24), nextRandom(60), 0));
+        knx.setParamByte(channelParam(iChannel, LOG_fTy1Day + 2 * lIndex), lDayWeekday);
+        knx.setParamByte(channelParam(iChannel, LOG_fTy1Month + 2 * lIndex), nextRandom(13) << 4);
+    }
+    knx.setParamInt(channelParam(iChannel, LOG_fTd1DuskDawn), lFunctions);
+}
+
+static void setupParams(const sLocation &iLocation)
+{
+    knx.setParamByte(LOG_NumChannels, COUNT_LOG_CHANNEL);
+    knx.setParamInt(LOG_StartupDelay, 0);
+    knx.setParamByte(LOG_Timezone, (iLocation.timezone << LOG_TimezoneShift) | (iLocation.useSummertime ? LOG_UseSummertimeMask : 0));
+    knx.setParamInt(LOG_Neujahr, 0xFFFFFFFF); // all holidays
+    knx.setParamFloat(LOG_Latitude, iLocation.latitude);
+    knx.setParamFloat(LOG_Longitude, iLocation.longitude);
+    for (uint8_t lChannel = 0; lChannel < COUNT_LOG_CHANNEL; lChannel++)
+    {
+        knx.setParamByte(channelParam(lChannel, LOG_fLogic), VAL_Logic_Timer);
+        knx.setParamByte(channelParam(lChannel, LOG_fTrigger), (lChannel & 1) ? BIT_EXT_INPUT_2 : 0);
+        knx.setParamByte(channelParam(lChannel, LOG_fTRestoreState), nextRandom(3) << LOG_fTRestoreStateShift);
+        knx.setParamByte(channelParam(lChannel, LOG_fTHoliday), (nextRandom(4) << LOG_fTHolidayShift) | ((nextRandom(4) % 3) << LOG_fTVacationShift));
+        knx.setParamByte(channelParam(lChannel, LOG_fODpt), VAL_DPT_1);
+        knx.setParamByte(channelParam(lChannel, LOG_fOOn), VAL_Out_Constant);
+        knx.setParamByte(channelParam(lChannel, LOG_fOOnDpt1), 1);
+        knx.setParamByte(channelParam(lChannel, LOG_fOOff), VAL_Out_Constant);
+        knx.setParamByte(channelParam(lChannel, LOG_fOOffDpt1), 0);
+        switch (lChannel % 5)
+        {
+            case 3:
+                setupYearlyTimer(lChannel);
+                break;
+            case 4:
+                setupDailyTimer(lChannel, true);
+                break;
+            default:
+                setupDailyTimer(lChannel, false);
+                break;
+        }
+    }
+}
+
+// each telegram of an output KO is one line of the schedule, it is written with the other telegrams of this minute
+static void onKoWritten(GroupObject &iKo)
+{
+    uint16_t lKoNumber = iKo.asap();
+    if (lKoNumber < LOG_KoOffset || (lKoNumber - LOG_KoOffset) % LOG_KoBlockSize != IO_Output - 1)
+        return;
+    sSwitchCount++;
+    if (sNumMinuteSwitches == BENCH_MAX_SWITCHES_PER_MINUTE)
+    {
+        fprintf(stderr, "more than %d switches in one minute\n", BENCH_MAX_SWITCHES_PER_MINUTE);
+        exit(1);
+    }
+    sMinuteSwitches[sNumMinuteSwitches].channel = (lKoNumber - LOG_KoOffset) / LOG_KoBlockSize + 1;
+    sMinuteSwitches[sNumMinuteSwitches].value = iKo.valueRef()[0];
+    sNumMinuteSwitches++;
+}
+
+// writes telegrams of current minute ordered by channel, telegrams of one channel keep their order
+static void writeMinuteSwitches()
+{
+    Timer &lTimer = Timer::instance();
+    for (uint16_t lIndex = 1; lIndex < sNumMinuteSwitches; lIndex++)
+    {
+        sSwitch lSwitch = sMinuteSwitches[lIndex];
+        uint16_t lInsert = lIndex;
+        for (; lInsert > 0 && sMinuteSwitches[lInsert - 1].channel > lSwitch.channel; lInsert--)
+            sMinuteSwitches[lInsert] = sMinuteSwitches[lInsert - 1];
+        sMinuteSwitches[lInsert] = lSwitch;
+    }
+    for (uint16_t lIndex = 0; lIndex < sNumMinuteSwitches; lIndex++)
+        fprintf(sSchedule, "%04d-%02d-%02d %02d:%02d channel %2d: %d\n", lTimer.getYear(), lTimer.getMonth(), lTimer.getDay(),
+                lTimer.getHour(), lTimer.getMinute(), sMinuteSwitches[lIndex].channel, sMinuteSwitches[lIndex].value);
+    sNumMinuteSwitches = 0;
+}
+
+static void receiveDateTime(uint16_t iYear, uint8_t iMonth, uint8_t iDay)
+{
+    struct tm lTime;
+    memset(&lTime, 0, sizeof(lTime));
+    lTime.tm_year = iYear; // bus telegrams have full year and month 1..12
+    lTime.tm_mon = iMonth;
+    lTime.tm_mday = iDay;
+    knx.getGroupObject(LOG_KoDate).receive(lTime, getDPT(VAL_DPT_11));
+    knx.getGroupObject(LOG_KoTime).receive(lTime, getDPT(VAL_DPT_10));
+}
+
+static void processLoops(uint8_t iCount)
+{
+    for (uint8_t lLoop = 0; lLoop < iCount; lLoop++)
+        gLogic.loop();
+    writeMinuteSwitches();
+}
+
+// both schedules are ordered by date, time and channel, so they are compared like a merge
+static int compare(const char *iScheduleFile, const char *iReferenceFile)
+{
+    FILE *lSchedule = fopen(iScheduleFile, "r");
+    FILE *lReference = fopen(iReferenceFile, "r");
+    if (lSchedule == nullptr || lReference == nullptr)
+    {
+        perror("open schedule");
+        return 2;
+    }
+    char lLine[BENCH_MAX_LINE];
+    char lReferenceLine[BENCH_MAX_LINE];
+    bool lHasLine = fgets(lLine, BENCH_MAX_LINE, lSchedule) != nullptr;
+    bool lHasReference = fgets(lReferenceLine, BENCH_MAX_LINE, lReference) != nullptr;
+    uint32_t lCount = 0;
+    uint32_t lMissing = 0;
+    uint32_t lAdditional = 0;
+    while (lHasLine || lHasReference)
+    {
+        int lOrder = !lHasLine ? 1 : !lHasReference ? -1 : strcmp(lLine, lReferenceLine);
+        if (lOrder < 0)
+        {
+            if (lMissing + lAdditional < 20)
+                printf("additional: %s", lLine);
+            lAdditional++;
+        }
+        else if (lOrder > 0)
+        {
+            if (lMissing + lAdditional < 20)
+                printf("missing:    %s", lReferenceLine);
+            lMissing++;
+        }
+        else
+            lCount++;
+        if (lOrder <= 0)
+            lHasLine = fgets(lLine, BENCH_MAX_LINE, lSchedule) != nullptr;
+        if (lOrder >= 0)
+            lHasReference = fgets(lReferenceLine, BENCH_MAX_LINE, lReference) != nullptr;
+    }
+    fclose(lSchedule);
+    fclose(lReference);
+    printf("%u switches equal to reference, %u missing, %u additional\n", lCount, lMissing, lAdditional);
+    return (lCount > 0 && lMissing == 0 && lAdditional == 0) ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 4 && strcmp(argv[1], "compare") == 0)
+        return compare(argv[2], argv[3]);
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s <location> <schedule file> | compare <schedule file> <reference schedule file>\n", argv[0]);
+        return 2;
+    }
+    const sLocation *lLocation = nullptr;
+    for (uint8_t lIndex = 0; lIndex < sizeof(cLocations) / sizeof(sLocation); lIndex++)
+        if (strcmp(argv[1], cLocations[lIndex].name) == 0)
+            lLocation = &cLocations[lIndex];
+    if (lLocation == nullptr)
+    {
+        fprintf(stderr, "unknown location %s\n", argv[1]);
+        return 2;
+    }
+    sSchedule = fopen(argv[2], "w");
+    if (sSchedule == nullptr)
+    {
+        perror(argv[2]);
+        return 2;
+    }
+    // logic module uses mktime() on local calendar values, so host time zone must not interfere
+    setenv("TZ", "UTC", 1);
+    tzset();
+
+    setupParams(*lLocation);
+    gHostKoWritten = onKoWritten;
+    hostSetMillis(1);
+    gLogic.setup(false);
+    receiveDateTime(BENCH_YEAR, 1, 1);
+    // startup includes timer restore
+    processLoops(BENCH_LOOPS_STARTUP);
+
+    Timer &lTimer = Timer::instance();
+    uint32_t lMinutes = 0;
+    clock_t lStart = clock();
+    for (uint16_t lDay = 0; lDay < BENCH_DAYS; lDay++)
+    {
+        // two weeks of vacation in summer
+        if (lDay == 212 || lDay == 226)
+            knx.getGroupObject(LOG_KoVacation).receive(lDay == 212, getDPT(VAL_DPT_1));
+        for (uint16_t lMinute = 0; lMinute < 1440; lMinute++)
+        {
+            for (uint8_t lSecond = 0; lSecond < 60; lSecond++)
+                lTimer.processClockStep();
+            processLoops(BENCH_LOOPS_PER_MINUTE);
+            lMinutes++;
+        }
+    }
+    double lSeconds = (double)(clock() - lStart) / CLOCKS_PER_SEC;
+    fclose(sSchedule);
+
+    printf("%s: %u switches in %u days, %.0f channel minutes/s, %.1f us CPU per simulated day\n",
+           lLocation->name, sSwitchCount, BENCH_DAYS, (lSeconds > 0) ? lMinutes * (double)COUNT_LOG_CHANNEL / lSeconds : 0.0,
+           lSeconds * 1e6 / BENCH_DAYS);
+    if (lTimer.getYear() != BENCH_YEAR + 1 || lTimer.getMonth() != 1 || lTimer.getDay() != 2)
+    {
+        fprintf(stderr, "clock ended at %04d-%02d-%02d\n", lTimer.getYear(), lTimer.getMonth(), lTimer.getDay());
+        return 1;
+    }
+    return (sSwitchCount > 0) ? 0 : 1;
+}
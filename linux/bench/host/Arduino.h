@@ -0,0 +1,45 @@
+#pragma once
+/***********************************
+ *
+ * Minimal Arduino API for host builds of logic module.
+ * millis() is a virtual clock, which is just advanced by the host program
+ *
+ * *********************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+// same as Arduino core, works on any numeric type
+#ifndef abs
+#define abs(x) ((x) > 0 ? (x) : -(x))
+#endif
+
+#define OUTPUT 1
+#define FALLING 2
+
+uint32_t millis();
+void delay(uint32_t iMillis);
+void pinMode(uint8_t iPin, uint8_t iMode);
+void tone(uint8_t iPin, uint16_t iFrequency);
+void noTone(uint8_t iPin);
+int digitalPinToInterrupt(uint8_t iPin);
+void attachInterrupt(int iInterrupt, void (*iCallback)(), int iMode);
+
+class HostSerial
+{
+  public:
+    void print(const char *iText);
+    void println(const char *iText);
+};
+extern HostSerial SerialUSB;
+
+// host side control of the virtual clock
+void hostSetMillis(uint32_t iMillis);
+void hostAdvanceMillis(uint32_t iMillis);
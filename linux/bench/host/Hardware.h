@@ -0,0 +1,4 @@
+#pragma once
+// host build has the same channel count as the firmware and an EEPROM, but no buzzer or LED
+#define COUNT_LOG_CHANNEL 99
+#define I2C_EEPROM_DEVICE_ADDRESSS 0x50
@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+
+#define FATAL_LOG_WRONG_CHANNEL_COUNT 1
+
+bool delayCheck(uint32_t iOldTimer, uint32_t iDuration);
+int printDebug(const char *iFormat, ...);
+void print(const char *iText);
+void println(const char *iText);
+void print(uint32_t iValue);
+void println(uint32_t iValue);
+void fatalError(uint8_t iErrorCode, const char *iErrorText);
+
+// debug output is suppressed on host, if not enabled
+extern bool gHostDebug;
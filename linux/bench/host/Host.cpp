@@ -0,0 +1,504 @@
+/***********************************
+ *
+ * Host implementation of Arduino, Wire and knx stack subset
+ * used by logic module sources.
+ *
+ * *********************************/
+
+#include <stdarg.h>
+#include "Arduino.h"
+#include "Wire.h"
+#include "knx_facade.h"
+#include "Helper.h"
+#include "PCA9632.h"
+
+// Arduino
+static uint32_t sMillis = 0;
+
+uint32_t millis()
+{
+    return sMillis;
+}
+
+void hostSetMillis(uint32_t iMillis)
+{
+    sMillis = iMillis;
+}
+
+void hostAdvanceMillis(uint32_t iMillis)
+{
+    sMillis += iMillis;
+}
+
+// time is virtual, so waiting means advancing the clock
+void delay(uint32_t iMillis)
+{
+    sMillis += iMillis;
+}
+
+void pinMode(uint8_t iPin, uint8_t iMode) {}
+void tone(uint8_t iPin, uint16_t iFrequency) {}
+void noTone(uint8_t iPin) {}
+void PCA9632_SetColor(uint8_t iRed, uint8_t iGreen, uint8_t iBlue) {}
+
+int digitalPinToInterrupt(uint8_t iPin)
+{
+    return iPin;
+}
+
+void attachInterrupt(int iInterrupt, void (*iCallback)(), int iMode) {}
+
+HostSerial SerialUSB;
+
+void HostSerial::print(const char *iText)
+{
+    fputs(iText, stdout);
+}
+
+void HostSerial::println(const char *iText)
+{
+    puts(iText);
+}
+
+// Helper
+bool gHostDebug = false;
+
+bool delayCheck(uint32_t iOldTimer, uint32_t iDuration)
+{
+    return millis() - iOldTimer >= iDuration;
+}
+
+int printDebug(const char *iFormat, ...)
+{
+    if (!gHostDebug)
+        return 0;
+    va_list lArgs;
+    va_start(lArgs, iFormat);
+    int lResult = vprintf(iFormat, lArgs);
+    va_end(lArgs);
+    return lResult;
+}
+
+void print(const char *iText)
+{
+    if (gHostDebug)
+        fputs(iText, stdout);
+}
+
+void println(const char *iText)
+{
+    if (gHostDebug)
+        puts(iText);
+}
+
+void print(uint32_t iValue)
+{
+    if (gHostDebug)
+        printf("%u", iValue);
+}
+
+void println(uint32_t iValue)
+{
+    if (gHostDebug)
+        printf("%u\n", iValue);
+}
+
+void fatalError(uint8_t iErrorCode, const char *iErrorText)
+{
+    fprintf(stderr, "fatal error %d: %s\n", iErrorCode, iErrorText);
+    exit(iErrorCode);
+}
+
+// Wire with 24C256 like EEPROM: 2 address bytes, page writes wrap within 32 byte page
+TwoWire Wire;
+
+void TwoWire::begin() {}
+void TwoWire::end() {}
+
+void TwoWire::beginTransmission(uint8_t iAddress)
+{
+    mDevice = iAddress;
+    mTxLength = 0;
+}
+
+size_t TwoWire::write(uint8_t iData)
+{
+    if (mTxLength >= sizeof(mTxBuffer))
+        return 0;
+    mTxBuffer[mTxLength++] = iData;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *iData, size_t iLength)
+{
+    size_t lWritten = 0;
+    for (size_t i = 0; i < iLength; i++)
+        lWritten += write(iData[i]);
+    return lWritten;
+}
+
+uint8_t TwoWire::endTransmission(bool iStop)
+{
+    if (mTxLength < 2)
+        return 0; // ready poll
+    mAddress = ((mTxBuffer[0] << 8) | mTxBuffer[1]) % HOST_EEPROM_SIZE;
+    if (mTxLength > 2)
+    {
+        mPageWrites++;
+        if (mFailAfterWrites >= 0 && mPageWrites > (uint32_t)mFailAfterWrites)
+            return 0;
+        uint16_t lPage = mAddress & ~31;
+        for (uint8_t i = 2; i < mTxLength; i++)
+            mEEPROM[lPage + ((mAddress + i - 2) & 31)] = mTxBuffer[i];
+    }
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t iAddress, uint8_t iLength)
+{
+    mRxLength = iLength;
+    return iLength;
+}
+
+int TwoWire::available()
+{
+    return mRxLength;
+}
+
+int TwoWire::read()
+{
+    if (mRxLength == 0)
+        return -1;
+    mRxLength--;
+    uint8_t lData = mEEPROM[mAddress];
+    mAddress = (mAddress + 1) % HOST_EEPROM_SIZE;
+    return lData;
+}
+
+// Dpt
+Dpt::Dpt() : mainGroup(0), subGroup(0), index(0) {}
+
+Dpt::Dpt(uint16_t iMainGroup, uint16_t iSubGroup, uint16_t iIndex)
+    : mainGroup(iMainGroup), subGroup(iSubGroup), index(iIndex) {}
+
+// KNXValue
+KNXValue::KNXValue(bool iValue) : KNXValue((int64_t)iValue) {}
+KNXValue::KNXValue(uint8_t iValue) : KNXValue((int64_t)iValue) {}
+KNXValue::KNXValue(int8_t iValue) : KNXValue((int64_t)iValue) {}
+KNXValue::KNXValue(uint16_t iValue) : KNXValue((int64_t)iValue) {}
+KNXValue::KNXValue(int16_t iValue) : KNXValue((int64_t)iValue) {}
+KNXValue::KNXValue(uint32_t iValue) : KNXValue((int64_t)iValue) {}
+KNXValue::KNXValue(int32_t iValue) : KNXValue((int64_t)iValue) {}
+KNXValue::KNXValue(float iValue) : KNXValue((double)iValue) {}
+
+KNXValue::KNXValue(int64_t iValue)
+{
+    memset(this, 0, sizeof(KNXValue));
+    mType = vtInt;
+    mInt = iValue;
+    mDouble = (double)iValue;
+}
+
+KNXValue::KNXValue(double iValue)
+{
+    memset(this, 0, sizeof(KNXValue));
+    mType = vtDouble;
+    mDouble = iValue;
+    mInt = (int64_t)iValue;
+}
+
+KNXValue::KNXValue(const char *iValue)
+{
+    memset(this, 0, sizeof(KNXValue));
+    mType = vtString;
+    memcpy(mString, iValue, strnlen(iValue, 14));
+}
+
+KNXValue::KNXValue(struct tm iValue)
+{
+    memset(this, 0, sizeof(KNXValue));
+    mType = vtTime;
+    mTime = iValue;
+}
+
+KNXValue::operator bool() const { return mInt != 0; }
+KNXValue::operator uint8_t() const { return (uint8_t)mInt; }
+KNXValue::operator int8_t() const { return (int8_t)mInt; }
+KNXValue::operator uint16_t() const { return (uint16_t)mInt; }
+KNXValue::operator int16_t() const { return (int16_t)mInt; }
+KNXValue::operator uint32_t() const { return (uint32_t)mInt; }
+KNXValue::operator int32_t() const { return (int32_t)mInt; }
+KNXValue::operator int64_t() const { return mInt; }
+KNXValue::operator float() const { return (float)mDouble; }
+KNXValue::operator double() const { return mDouble; }
+KNXValue::operator const char *() const { return mString; }
+KNXValue::operator struct tm() const { return mTime; }
+
+// GroupObject, values are stored in KNX encoding
+GroupObjectUpdatedHandler GroupObject::sCallback = nullptr;
+void (*gHostKoWritten)(GroupObject &iKo) = nullptr;
+
+static void encodeFloat16(double iValue, uint8_t *cData)
+{
+    int32_t lMantissa = (int32_t)lround(iValue * 100.0);
+    uint8_t lExponent = 0;
+    while (lMantissa < -2048 || lMantissa > 2047)
+    {
+        lMantissa /= 2;
+        lExponent++;
+    }
+    uint16_t lRaw = (lMantissa < 0 ? 0x8000 : 0) | (lExponent << 11) | (lMantissa & 0x07FF);
+    cData[0] = lRaw >> 8;
+    cData[1] = lRaw & 0xFF;
+}
+
+static double decodeFloat16(const uint8_t *iData)
+{
+    uint16_t lRaw = (iData[0] << 8) | iData[1];
+    int32_t lMantissa = lRaw & 0x07FF;
+    if (lRaw & 0x8000)
+        lMantissa -= 2048;
+    return lMantissa * (1 << ((lRaw >> 11) & 0x0F)) / 100.0;
+}
+
+static void encodeValue(const KNXValue &iValue, const Dpt &iDpt, uint8_t *cData)
+{
+    int64_t lInt = iValue.mInt;
+    switch (iDpt.mainGroup)
+    {
+        case 5:
+            cData[0] = (iDpt.subGroup == 1) ? (uint8_t)lround(iValue.mDouble * 255.0 / 100.0) : (uint8_t)lInt;
+            break;
+        case 7:
+        case 8:
+            cData[0] = (lInt >> 8) & 0xFF;
+            cData[1] = lInt & 0xFF;
+            break;
+        case 9:
+            encodeFloat16(iValue.mDouble, cData);
+            break;
+        case 10:
+            cData[0] = (((iValue.mTime.tm_wday == 0 ? 7 : iValue.mTime.tm_wday) & 7) << 5) | (iValue.mTime.tm_hour & 0x1F);
+            cData[1] = iValue.mTime.tm_min;
+            cData[2] = iValue.mTime.tm_sec;
+            break;
+        case 11:
+            cData[0] = iValue.mTime.tm_mday;
+            cData[1] = iValue.mTime.tm_mon;
+            cData[2] = iValue.mTime.tm_year % 100;
+            break;
+        case 16:
+            memset(cData, 0, 14);
+            memcpy(cData, iValue.mString, strnlen(iValue.mString, 14));
+            break;
+        case 232:
+            cData[0] = (lInt >> 16) & 0xFF;
+            cData[1] = (lInt >> 8) & 0xFF;
+            cData[2] = lInt & 0xFF;
+            break;
+        default: // 1, 2, 6, 17
+            cData[0] = (iDpt.mainGroup == 1) ? (lInt != 0) : (uint8_t)lInt;
+            break;
+    }
+}
+
+static KNXValue decodeValue(const uint8_t *iData, const Dpt &iDpt)
+{
+    switch (iDpt.mainGroup)
+    {
+        case 5:
+            if (iDpt.subGroup == 1)
+                return KNXValue((double)(uint8_t)lround(iData[0] * 100.0 / 255.0));
+            return KNXValue(iData[0]);
+        case 6:
+            return KNXValue((int8_t)iData[0]);
+        case 7:
+            return KNXValue((uint16_t)((iData[0] << 8) | iData[1]));
+        case 8:
+            return KNXValue((int16_t)((iData[0] << 8) | iData[1]));
+        case 9:
+            return KNXValue(decodeFloat16(iData));
+        case 10:
+        case 11:
+        {
+            struct tm lTime;
+            memset(&lTime, 0, sizeof(lTime));
+            if (iDpt.mainGroup == 10)
+            {
+                lTime.tm_wday = (iData[0] >> 5) % 7;
+                lTime.tm_hour = iData[0] & 0x1F;
+                lTime.tm_min = iData[1];
+                lTime.tm_sec = iData[2];
+            }
+            else
+            {
+                // same as knx stack: month is 1 based, year is full year
+                lTime.tm_mday = iData[0];
+                lTime.tm_mon = iData[1];
+                lTime.tm_year = iData[2] + ((iData[2] < 90) ? 2000 : 1900);
+            }
+            return KNXValue(lTime);
+        }
+        case 16:
+        {
+            char lText[15] = {0};
+            memcpy(lText, iData, 14);
+            return KNXValue((const char *)lText);
+        }
+        case 232:
+            return KNXValue((int32_t)((iData[0] << 16) | (iData[1] << 8) | iData[2]));
+        default: // 1, 2, 17
+            return KNXValue(iData[0]);
+    }
+}
+
+uint16_t GroupObject::asap()
+{
+    return mAsap;
+}
+
+uint8_t *GroupObject::valueRef()
+{
+    return mData;
+}
+
+size_t GroupObject::valueSize()
+{
+    return mSize;
+}
+
+void GroupObject::objectWritten()
+{
+    if (gHostKoWritten)
+        gHostKoWritten(*this);
+}
+
+void GroupObject::requestObjectRead() {}
+
+KNXValue GroupObject::value(const Dpt &iDpt)
+{
+    return decodeValue(mData, iDpt);
+}
+
+void GroupObject::value(const KNXValue &iValue, const Dpt &iDpt)
+{
+    valueNoSend(iValue, iDpt);
+    objectWritten();
+}
+
+void GroupObject::valueNoSend(const KNXValue &iValue, const Dpt &iDpt)
+{
+    encodeValue(iValue, iDpt, mData);
+}
+
+void GroupObject::receive(const KNXValue &iValue, const Dpt &iDpt)
+{
+    valueNoSend(iValue, iDpt);
+    if (sCallback)
+        sCallback(*this);
+}
+
+void GroupObject::classCallback(GroupObjectUpdatedHandler iHandler)
+{
+    sCallback = iHandler;
+}
+
+GroupObjectUpdatedHandler GroupObject::classCallback()
+{
+    return sCallback;
+}
+
+// TableObject
+BeforeTableUnloadCallback TableObject::sCallback = nullptr;
+
+void TableObject::addBeforeTableUnloadCallback(BeforeTableUnloadCallback iCallback)
+{
+    sCallback = iCallback;
+}
+
+BeforeTableUnloadCallback TableObject::getBeforeTableUnloadCallback()
+{
+    return sCallback;
+}
+
+// KnxFacade
+KnxFacade knx;
+
+uint8_t KnxFacade::paramByte(uint32_t iAddress)
+{
+    return mParams[iAddress];
+}
+
+uint16_t KnxFacade::paramWord(uint32_t iAddress)
+{
+    return (mParams[iAddress] << 8) | mParams[iAddress + 1];
+}
+
+uint32_t KnxFacade::paramInt(uint32_t iAddress)
+{
+    return ((uint32_t)mParams[iAddress] << 24) | (mParams[iAddress + 1] << 16) | (mParams[iAddress + 2] << 8) | mParams[iAddress + 3];
+}
+
+uint8_t *KnxFacade::paramData(uint32_t iAddress)
+{
+    return mParams + iAddress;
+}
+
+GroupObject &KnxFacade::getGroupObject(uint16_t iAsap)
+{
+    if (!mGroupObjectsInitialized)
+    {
+        for (uint16_t i = 0; i < HOST_GROUP_OBJECTS; i++)
+            mGroupObjects[i].mAsap = i;
+        mGroupObjectsInitialized = true;
+    }
+    return mGroupObjects[iAsap % HOST_GROUP_OBJECTS];
+}
+
+bool KnxFacade::configured()
+{
+    return true;
+}
+
+void KnxFacade::loop() {}
+
+void KnxFacade::restart(uint16_t iIndividualAddress) {}
+
+void KnxFacade::addBeforeRestartCallback(BeforeRestartCallback iCallback)
+{
+    mBeforeRestart = iCallback;
+}
+
+BeforeRestartCallback KnxFacade::getBeforeRestartCallback()
+{
+    return mBeforeRestart;
+}
+
+void KnxFacade::setParamByte(uint32_t iAddress, uint8_t iValue)
+{
+    mParams[iAddress] = iValue;
+}
+
+void KnxFacade::setParamWord(uint32_t iAddress, uint16_t iValue)
+{
+    mParams[iAddress] = iValue >> 8;
+    mParams[iAddress + 1] = iValue & 0xFF;
+}
+
+void KnxFacade::setParamInt(uint32_t iAddress, uint32_t iValue)
+{
+    setParamWord(iAddress, iValue >> 16);
+    setParamWord(iAddress + 2, iValue & 0xFFFF);
+}
+
+void KnxFacade::setParamFloat(uint32_t iAddress, float iValue)
+{
+    uint32_t lRaw;
+    memcpy(&lRaw, &iValue, sizeof(lRaw));
+    setParamInt(iAddress, lRaw);
+}
+
+void KnxFacade::setGroupObjectSize(uint16_t iAsap, uint8_t iSize)
+{
+    getGroupObject(iAsap).mSize = iSize;
+}
@@ -0,0 +1,3 @@
+#pragma once
+#include <stdint.h>
+void PCA9632_SetColor(uint8_t iRed, uint8_t iGreen, uint8_t iBlue);
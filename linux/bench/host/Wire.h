@@ -0,0 +1,39 @@
+#pragma once
+/***********************************
+ *
+ * i2c for host builds, the EEPROM (24C256 like, 32 byte pages)
+ * is simulated in memory and is ready immediately after a write
+ *
+ * *********************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define HOST_EEPROM_SIZE 32768
+
+class TwoWire
+{
+  public:
+    void begin();
+    void end();
+    void beginTransmission(uint8_t iAddress);
+    uint8_t endTransmission(bool iStop = true);
+    size_t write(uint8_t iData);
+    size_t write(const uint8_t *iData, size_t iLength);
+    uint8_t requestFrom(uint8_t iAddress, uint8_t iLength);
+    int available();
+    int read();
+
+    // host side access
+    uint8_t mEEPROM[HOST_EEPROM_SIZE];
+    uint32_t mPageWrites = 0;
+    int32_t mFailAfterWrites = -1; // simulates power failure: further page writes are lost
+
+  private:
+    uint8_t mDevice = 0;
+    uint16_t mAddress = 0;
+    uint8_t mTxBuffer[34];
+    uint8_t mTxLength = 0;
+    uint8_t mRxLength = 0;
+};
+extern TwoWire Wire;
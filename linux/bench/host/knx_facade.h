@@ -0,0 +1,158 @@
+#pragma once
+/***********************************
+ *
+ * Subset of knx stack API used by logic module, for host builds.
+ * Group objects hold their value in KNX encoding, so valueRef() and
+ * valueSize() behave like on the device. Written values are reported
+ * to an optional hook instead of being sent to a bus.
+ *
+ * *********************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include "Arduino.h"
+
+class Dpt
+{
+  public:
+    Dpt();
+    Dpt(uint16_t iMainGroup, uint16_t iSubGroup, uint16_t iIndex = 0);
+
+    uint16_t mainGroup;
+    uint16_t subGroup;
+    uint16_t index;
+};
+
+class KNXValue
+{
+  public:
+    KNXValue(bool iValue);
+    KNXValue(uint8_t iValue);
+    KNXValue(int8_t iValue);
+    KNXValue(uint16_t iValue);
+    KNXValue(int16_t iValue);
+    KNXValue(uint32_t iValue);
+    KNXValue(int32_t iValue);
+    KNXValue(int64_t iValue);
+    KNXValue(float iValue);
+    KNXValue(double iValue);
+    KNXValue(const char *iValue);
+    KNXValue(struct tm iValue);
+
+    operator bool() const;
+    operator uint8_t() const;
+    operator int8_t() const;
+    operator uint16_t() const;
+    operator int16_t() const;
+    operator uint32_t() const;
+    operator int32_t() const;
+    operator int64_t() const;
+    operator float() const;
+    operator double() const;
+    operator const char *() const;
+    operator struct tm() const;
+
+    enum eType
+    {
+        vtInt,
+        vtDouble,
+        vtString,
+        vtTime
+    };
+    eType mType;
+    int64_t mInt;
+    double mDouble;
+    char mString[15];
+    struct tm mTime;
+};
+
+class GroupObject;
+typedef void (*GroupObjectUpdatedHandler)(GroupObject &iKo);
+
+class GroupObject
+{
+  public:
+    uint16_t asap();
+    uint8_t *valueRef();
+    size_t valueSize();
+    void objectWritten();
+    void requestObjectRead();
+    KNXValue value(const Dpt &iDpt);
+    void value(const KNXValue &iValue, const Dpt &iDpt);
+    void valueNoSend(const KNXValue &iValue, const Dpt &iDpt);
+    static void classCallback(GroupObjectUpdatedHandler iHandler);
+    static GroupObjectUpdatedHandler classCallback();
+
+    // host side: process value as if received from bus
+    void receive(const KNXValue &iValue, const Dpt &iDpt);
+
+    uint16_t mAsap = 0;
+    uint8_t mSize = 1;
+    uint8_t mData[14] = {0};
+
+  private:
+    static GroupObjectUpdatedHandler sCallback;
+};
+
+// called whenever logic module sends a value
+extern void (*gHostKoWritten)(GroupObject &iKo);
+
+enum LoadState
+{
+    LS_UNLOADED = 0,
+    LS_LOADED = 1,
+    LS_LOADING = 2,
+    LS_ERROR = 3,
+    LS_UNLOADING = 4,
+    LS_LOADCOMPLETING = 5
+};
+
+class TableObject;
+typedef void (*BeforeTableUnloadCallback)(TableObject &iTableObject, LoadState &iNewState);
+
+class TableObject
+{
+  public:
+    static void addBeforeTableUnloadCallback(BeforeTableUnloadCallback iCallback);
+    static BeforeTableUnloadCallback getBeforeTableUnloadCallback();
+
+  private:
+    static BeforeTableUnloadCallback sCallback;
+};
+
+typedef void (*BeforeRestartCallback)();
+
+#define HOST_PARAM_SIZE 16384
+#define HOST_GROUP_OBJECTS 1024
+
+class KnxFacade
+{
+  public:
+    uint8_t paramByte(uint32_t iAddress);
+    uint16_t paramWord(uint32_t iAddress);
+    uint32_t paramInt(uint32_t iAddress);
+    uint8_t *paramData(uint32_t iAddress);
+    GroupObject &getGroupObject(uint16_t iAsap);
+    bool configured();
+    void loop();
+    void restart(uint16_t iIndividualAddress);
+    void addBeforeRestartCallback(BeforeRestartCallback iCallback);
+    BeforeRestartCallback getBeforeRestartCallback();
+
+    // host side setup of param memory, multibyte values are big endian like in knxprod
+    void setParamByte(uint32_t iAddress, uint8_t iValue);
+    void setParamWord(uint32_t iAddress, uint16_t iValue);
+    void setParamInt(uint32_t iAddress, uint32_t iValue);
+    void setParamFloat(uint32_t iAddress, float iValue);
+    void setGroupObjectSize(uint16_t iAsap, uint8_t iSize);
+
+  private:
+    uint8_t mParams[HOST_PARAM_SIZE] = {0};
+    GroupObject mGroupObjects[HOST_GROUP_OBJECTS];
+    bool mGroupObjectsInitialized = false;
+    BeforeRestartCallback mBeforeRestart = nullptr;
+};
+
+extern KnxFacade knx;
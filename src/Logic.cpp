@@ -4,6 +4,7 @@
 #include "Timer.h"
 #include "TimerRestore.h"
 #include "PCA9632.h"
+#include <new>
 #ifdef WATCHDOG
 #include <Adafruit_SleepyDog.h>
 uint32_t gWatchdogDelay;
@@ -11,13 +12,21 @@ uint8_t gWatchdogResetCause;
 #endif
 
 
+// identifies a written snapshot slot header, sequence and CRC decide about its validity
 uint8_t Logic::sMagicWord[] = {0xAE, 0x49, 0xD2, 0x9F};
 Timer &Logic::sTimer = Timer::instance(); // singleton
 TimerRestore &Logic::sTimerRestore = TimerRestore::instance(); // singleton
+TimingWheel &Logic::sTimingWheel = TimingWheel::instance(); // singleton
+
+alignas(LogicChannel) uint8_t Logic::sChannelPool[LOG_ChannelsFirmware * sizeof(LogicChannel)];
+uint32_t Logic::sStatePool[(LOG_ChannelsFirmware * LOG_StateBytesPerChannel + 3) / 4];
 
 char Logic::sDiagnoseBuffer[16] = {0};
 sLoopCallbackParams Logic::sLoopCallbacks[5] = {nullptr};
 uint8_t Logic::sNumLoopCallbacks = 0;
+sKoCallbackParams Logic::sKoCallbacks[LOG_KoCallbacksMax] = {{nullptr}};
+uint8_t Logic::sNumKoCallbacks = 0;
+sKoDispatch Logic::sKoDispatchTable[LOG_KoDispatchSize] = {{0}};
 
 // callbacks have to be static members
 void Logic::onInputKoHandler(GroupObject &iKo) {
@@ -38,9 +47,12 @@ void Logic::onBeforeTableUnloadHandler(TableObject & iTableObject, LoadState & i
     if (iNewState == 0)
     {
         printDebug("Table unload called\n");
+        // parameters might change, cached ones have to be decoded again
+        LogicChannel::sLogic->invalidateChannelParams();
         if (sLastCalled == 0 || delayCheck(sLastCalled, 10000))
         {
-            LogicChannel::sLogic->writeAllInputsToEEPROMFacade();
+            // save is done asynchronously in loop, so telegrams from ETS are still processed
+            LogicChannel::sLogic->startSave();
             sLastCalled = millis();
         }
     }
@@ -51,6 +63,12 @@ void Logic::onSafePinInterruptHandler()
     LogicChannel::sLogic->mSaveInterruptTimestamp = millis();
 }
 
+// each channel owns DLY_COUNT consecutive timers in timing wheel
+void Logic::onDelayExpiredHandler(uint16_t iTimerId)
+{
+    LogicChannel::sLogic->mChannel[iTimerId / DLY_COUNT]->processDelayExpired(iTimerId % DLY_COUNT);
+}
+
 void Logic::addLoopCallback(loopCallback iLoopCallback, void *iThis) {
     sLoopCallbackParams lParams;
     lParams.callback = iLoopCallback;
@@ -58,9 +76,73 @@ void Logic::addLoopCallback(loopCallback iLoopCallback, void *iThis) {
     Logic::sLoopCallbacks[sNumLoopCallbacks++] = lParams;
 }
 
+// registers a handler for an incoming KO, the handler gets the given channel and IO index
+void Logic::addKoCallback(uint16_t iKoNumber, koCallback iKoCallback, void *iThis, uint8_t iChannelId, uint8_t iIOIndex)
+{
+    if (iKoNumber >= LOG_KoDispatchSize)
+        return;
+    uint8_t lCallback = 0;
+    while (lCallback < sNumKoCallbacks && (sKoCallbacks[lCallback].callback != iKoCallback || sKoCallbacks[lCallback].instance != iThis))
+        lCallback++;
+    if (lCallback == sNumKoCallbacks)
+    {
+        if (sNumKoCallbacks == LOG_KoCallbacksMax)
+            return;
+        sKoCallbacks[lCallback].callback = iKoCallback;
+        sKoCallbacks[lCallback].instance = iThis;
+        sNumKoCallbacks++;
+    }
+    sKoDispatch &lEntry = sKoDispatchTable[iKoNumber];
+    lEntry.callback = lCallback + 1;
+    lEntry.channelId = iChannelId;
+    lEntry.ioIndex = iIOIndex;
+}
+
+void Logic::onTimeKoHandler(void *iThis, GroupObject &iKo, uint8_t iChannelId, uint8_t iIOIndex)
+{
+    struct tm lTmp = iKo.value(getDPT(VAL_DPT_10));
+    sTimer.setTimeFromBus(&lTmp);
+}
+
+void Logic::onDateKoHandler(void *iThis, GroupObject &iKo, uint8_t iChannelId, uint8_t iIOIndex)
+{
+    struct tm lTmp = iKo.value(getDPT(VAL_DPT_11));
+    sTimer.setDateFromBus(&lTmp);
+}
+
+void Logic::onDiagnoseKoHandler(void *iThis, GroupObject &iKo, uint8_t iChannelId, uint8_t iIOIndex)
+{
+    ((Logic *)iThis)->processDiagnoseCommand(iKo);
+}
+
+void Logic::onLockKoHandler(void *iThis, GroupObject &iKo, uint8_t iChannelId, uint8_t iIOIndex)
+{
+    if (!iKo.value(getDPT(VAL_DPT_1)))
+        return;
+#ifdef BUZZER_PIN
+    // turn off buzzer in case of lock
+    if (iKo.asap() == LOG_KoBuzzerLock)
+        noTone(BUZZER_PIN);
+#endif
+#ifdef I2C_RGBLED_DEVICE_ADDRESS
+    // turn off LED in case of lock
+    if (iKo.asap() == LOG_KoLedLock)
+        PCA9632_SetColor(0, 0, 0);
+#endif
+}
+
+void Logic::onChannelInputKoHandler(void *iThis, GroupObject &iKo, uint8_t iChannelId, uint8_t iIOIndex)
+{
+    Logic *lLogic = (Logic *)iThis;
+    if (lLogic->getSaveSize(iChannelId, iIOIndex))
+        lLogic->markInputDirty(iChannelId, iIOIndex);
+    lLogic->mChannel[iChannelId]->processInput(iIOIndex);
+}
+
 Logic::Logic()
 {
     LogicChannel::sLogic = this;
+    LogicChannel::sState = &mState;
 }
 
 Logic::~Logic()
@@ -71,23 +153,182 @@ LogicChannel *Logic::getChannel(uint8_t iChannelId) {
     return mChannel[iChannelId];
 }
 
-uint8_t Logic::getChannelId(LogicChannel *iChannel) {
-    uint8_t lResult = -1;
+// fills dispatch table with all KO handled by logic
+void Logic::prepareKoDispatch()
+{
+    addKoCallback(LOG_KoTime, onTimeKoHandler, this);
+    addKoCallback(LOG_KoDate, onDateKoHandler, this);
+    addKoCallback(LOG_KoDiagnose, onDiagnoseKoHandler, this);
+#ifdef BUZZER_PIN
+    addKoCallback(LOG_KoBuzzerLock, onLockKoHandler, this);
+#endif
+#ifdef I2C_RGBLED_DEVICE_ADDRESS
+    addKoCallback(LOG_KoLedLock, onLockKoHandler, this);
+#endif
+    for (uint8_t lChannelId = 0; lChannelId < mNumChannels; lChannelId++)
+        for (uint8_t lIOIndex = 1; lIOIndex <= LOG_KoBlockSize; lIOIndex++)
+            addKoCallback(LOG_KoOffset + lChannelId * LOG_KoBlockSize + lIOIndex - 1, onChannelInputKoHandler, this, lChannelId, lIOIndex);
+}
+
+// builds the fan-out index from internal input settings, so an output
+// change is just forwarded to channels, which really use it
+void Logic::prepareInternalInputs()
+{
+    // count subscribers per source channel
+    for (uint8_t lIndex = 0; lIndex <= mNumChannels; lIndex++)
+        mInternalInputStart[lIndex] = 0;
     for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
     {
-        if (mChannel[lIndex] == iChannel) {
-            lResult = lIndex;
-            break;
+        for (uint8_t lInput = BIT_INT_INPUT_1; lInput <= BIT_INT_INPUT_2; lInput <<= 1)
+        {
+            uint8_t lSource = mChannel[lIndex]->getInternalInputSource(lInput);
+            if (lSource > 0 && lSource <= mNumChannels)
+                mInternalInputStart[lSource]++;
         }
     }
-    return lResult;
+    // counts to positions, now mInternalInputStart[n] is start of channel n
+    for (uint8_t lIndex = 1; lIndex <= mNumChannels; lIndex++)
+        mInternalInputStart[lIndex] += mInternalInputStart[lIndex - 1];
+    // fill entries, mInternalInputStart[n] is used as insert position for channel n
+    for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
+    {
+        for (uint8_t lInput = BIT_INT_INPUT_1; lInput <= BIT_INT_INPUT_2; lInput <<= 1)
+        {
+            uint8_t lSource = mChannel[lIndex]->getInternalInputSource(lInput);
+            if (lSource > 0 && lSource <= mNumChannels)
+                mInternalInputs[mInternalInputStart[lSource - 1]++] = (lIndex << 1) | (lInput == BIT_INT_INPUT_2);
+        }
+    }
+    // now mInternalInputStart[n] is end of channel n, shift back to start positions
+    for (uint8_t lIndex = mNumChannels; lIndex > 0; lIndex--)
+        mInternalInputStart[lIndex] = mInternalInputStart[lIndex - 1];
+    mInternalInputStart[0] = 0;
+}
+
+// schedules a channel for pipeline processing, each channel is queued at most once
+void Logic::enqueueChannel(uint8_t iChannelId)
+{
+    uint8_t lMask = 1 << (iChannelId & 7);
+    if ((mReadyFlags[iChannelId >> 3] & lMask) == 0)
+    {
+        mReadyFlags[iChannelId >> 3] |= lMask;
+        mReadyQueue[mNumReady++] = iChannelId;
+    }
+}
+
+// removes a queue entry by replacing it with the last one
+void Logic::removeFromReadyQueue(uint8_t iQueueIndex)
+{
+    uint8_t lChannelId = mReadyQueue[iQueueIndex];
+    mReadyFlags[lChannelId >> 3] &= ~(1 << (lChannelId & 7));
+    mReadyQueue[iQueueIndex] = mReadyQueue[--mNumReady];
+}
+
+void Logic::invalidateChannelParams()
+{
+    for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
+        mChannel[lIndex]->invalidateParams();
+}
+
+// a channel with AND, OR or EXOR is evaluated in batch
+void Logic::addToLogicBatch(uint8_t iChannelId, uint8_t iLogic, uint8_t iActiveInputs, bool iCalculateInvalid)
+{
+    uint8_t lWord = iChannelId >> 5;
+    uint32_t lMask = 1UL << (iChannelId & 31);
+    for (uint8_t lInput = 0; lInput < 4; lInput++)
+    {
+        if (iActiveInputs & (1 << lInput))
+            mBatchActive[lInput][lWord] |= lMask;
+    }
+    if (iLogic == VAL_Logic_And)
+        mBatchAnd[lWord] |= lMask;
+    else if (iLogic == VAL_Logic_Or)
+        mBatchOr[lWord] |= lMask;
+    else if (iLogic == VAL_Logic_ExOr)
+        mBatchExOr[lWord] |= lMask;
+    if (iCalculateInvalid)
+        mBatchCalculateInvalid[lWord] |= lMask;
+}
+
+// mirrors input state of a channel to the bit planes and marks it for evaluation
+void Logic::updateLogicBatch(uint8_t iChannelId, uint8_t iCurrentIn, uint8_t iValidActiveIO)
+{
+    uint8_t lWord = iChannelId >> 5;
+    uint32_t lMask = 1UL << (iChannelId & 31);
+    for (uint8_t lInput = 0; lInput < 4; lInput++)
+    {
+        mBatchInput[lInput][lWord] &= ~lMask;
+        if (iCurrentIn & (1 << lInput))
+            mBatchInput[lInput][lWord] |= lMask;
+        mBatchValid[lInput][lWord] &= ~lMask;
+        if (iValidActiveIO & (1 << lInput))
+            mBatchValid[lInput][lWord] |= lMask;
+    }
+    mBatchDirty[lWord] |= lMask;
+}
+
+// evaluates all changed AND, OR and EXOR channels with word wide operations
+// and hands the results to the channel pipeline
+void Logic::processLogicBatch()
+{
+    for (uint8_t lWord = 0; lWord < LOGIC_BATCH_WORDS; lWord++)
+    {
+        uint32_t lDirty = mBatchDirty[lWord];
+        if (lDirty == 0)
+            continue;
+        uint32_t lAllValid = 0xFFFFFFFF;
+        uint32_t lAnd = 0xFFFFFFFF;
+        uint32_t lOr = 0;
+        uint32_t lExOr = 0;
+        for (uint8_t lInput = 0; lInput < 4; lInput++)
+        {
+            uint32_t lCurrent = mBatchInput[lInput][lWord] & mBatchValid[lInput][lWord];
+            lAllValid &= ~(mBatchValid[lInput][lWord] ^ mBatchActive[lInput][lWord]);
+            lAnd &= ~(lCurrent ^ mBatchActive[lInput][lWord]); // invalid inputs count as 1
+            lOr |= lCurrent;
+            lExOr ^= lCurrent;                                 // invalid inputs count as non existing
+        }
+        uint32_t lEvaluated = mBatchCalculateInvalid[lWord] | lAllValid;
+        uint32_t lOutput = (mBatchAnd[lWord] & lAnd) | (mBatchOr[lWord] & lOr) | (mBatchExOr[lWord] & lExOr);
+        while (lDirty)
+        {
+            uint8_t lBit = __builtin_ctz(lDirty);
+            lDirty &= lDirty - 1;
+            LogicChannel *lChannel = mChannel[lWord * 32 + lBit];
+            // like all pipeline steps, evaluation waits until channel is running
+            if (!lChannel->isRunning())
+                continue;
+            mBatchDirty[lWord] &= ~(1UL << lBit);
+            lChannel->finishLogic((lEvaluated >> lBit) & 1, true, (lOutput >> lBit) & 1);
+        }
+    }
+}
+
+// carves one array per state field from state pool, arrays of the same field
+// are contiguous, so a scan over all channels reads consecutive memory
+void Logic::setupChannelState()
+{
+    uint8_t *lPool = (uint8_t *)sStatePool;
+    mState.currentPipeline = sStatePool;
+    lPool += mNumChannels * sizeof(uint32_t);
+    mState.triggerIO = lPool;
+    lPool += mNumChannels;
+    mState.validActiveIO = lPool;
+    lPool += mNumChannels;
+    mState.currentIn = lPool;
+    lPool += mNumChannels;
+    mState.currentOut = lPool;
+    lPool += mNumChannels;
+    mState.currentIODebug = lPool;
+    lPool += mNumChannels;
+    mState.expiredDelays = lPool;
 }
 
 bool Logic::prepareChannels() {
     bool lResult = false;
     for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
     {
-        lResult = lResult || mChannel[lIndex]->prepareChannel();
+        lResult = mChannel[lIndex]->prepareChannel() || lResult;
     }
     return lResult;
 }
@@ -95,12 +336,12 @@ bool Logic::prepareChannels() {
 // we trigger all associated internal inputs with the new value
 void Logic::processAllInternalInputs(LogicChannel *iChannel, bool iValue)
 {
-    // search for any internal input associated to this channel
-    for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
+    // trigger just internal inputs associated to this channel
+    uint8_t lChannelId = iChannel->getChannelId();
+    for (uint16_t lIndex = mInternalInputStart[lChannelId]; lIndex < mInternalInputStart[lChannelId + 1]; lIndex++)
     {
-        LogicChannel *lChannel = mChannel[lIndex];
-        uint8_t lChannelId = getChannelId(iChannel);
-        lChannel->processInternalInputs(lChannelId, iValue);
+        uint16_t lTarget = mInternalInputs[lIndex];
+        mChannel[lTarget >> 1]->processInternalInput((lTarget & 1) ? BIT_INT_INPUT_2 : BIT_INT_INPUT_1, iValue);
     }
 }
 
@@ -116,93 +357,417 @@ void Logic::processReadRequests() {
         }
         sCalled = true;
     }
-    // date and time are red from bus every minute until a response is received
+    // date and time are red from bus every 30 seconds until a response is received,
+    // later on time is just red if the estimated error of local clock is too high
     if ((knx.paramByte(LOG_ReadTimeDate) & LOG_ReadTimeDateMask))
     {
         eTimeValid lValid = sTimer.isTimerValid();
-        if (delayCheck(sDelay, 30000) && lValid != tmValid)
+        bool lNeedsTime = !(lValid & tmMinutesValid) || sTimer.needsTimeSync();
+        if (delayCheck(sDelay, 30000) && (lValid != tmValid || lNeedsTime))
         {
             sDelay = millis();
-            if (lValid != tmMinutesValid)
+            if (lNeedsTime)
                 knx.getGroupObject(LOG_KoTime).requestObjectRead();
-            if (lValid != tmDateValid)
+            if (!(lValid & tmDateValid))
                 knx.getGroupObject(LOG_KoDate).requestObjectRead();
         }
     }
 }
 // EEPROM handling
-// We assume at max 128 channels, each channel 2 inputs, each input max 4 bytes (value) and 1 byte (DPT) = 128 * 2 * (4 + 1) = 1280 bytes to write
-// So we use 40 Pages for data and one (first) page for aditional information (metadata).
-// The DPT list is written startig with page 1 (address 32 = 0x20). It is written at device startup and is not timing critical.
-// We have 256 Bytes in 16 x 16 byte blocks (8 pages), takes 16 * 5 ms = 80 ms, just at startup time and just if necessary.
-// Writing data itself is timing critical during power failure.
-// At first, magic word at address 12 = 0x0C is deleted (5 ms).
-// The data itself is written in 16 byte blocks, each 5 ms means 1024 / 16 * 5 ms = 64 * 5 ms = 320 ms write time, starting at page 9, address 160 = 0xA0.
-// Finally, we write magic word at Address 12 again as an ack, that all data was successfully written (5 ms)
-// The resulting write time is at max 5 + 320 + 5 = 370 ms
+// Each channel has 2 inputs, each input max 4 bytes (value), so at most LOG_ChannelsFirmware * 2 * 4 bytes are written
+// (792 bytes for 99 channels).
+// We use 40 Pages for data and one (first) page for aditional information (metadata).
+// Just inputs set as "store in memory" are saved, each one with its real value size, packed in channel order.
+// The 40 pages are split into 2 snapshot slots (A: page 1-20, B: page 21-40), which are written alternating,
+// so an interrupted save never destroys the last valid snapshot. Each slot has a 16 byte header
+// (magic word, layout hash, sequence, CRC-32) followed by at max 624 bytes of values.
+// If saved inputs need more, slot A spans all 40 pages (max. 1264 bytes) and is the only slot, then an
+// interrupted save invalidates all saved values. This is reported on startup, inputs beyond 1264 bytes are not saved.
+// The layout hash replaces a DPT list: if the hash does not fit, any input or DPT changed and no value is restored.
+// On startup the slot with the highest sequence, whose CRC fits, is restored.
+// Writing data itself is timing critical during power failure, there it is done synchronously.
+// Otherwise (ETS programming) one page is written per loop, so knx.loop() is still called.
+// Instead of fixed delays the EEPROM is polled for the end of a write cycle.
+// The data itself is written in 16 byte blocks to the inactive slot, each 5 ms means
+// at max 624 / 16 * 5 ms = 39 * 5 ms = 195 ms write time (single slot: 79 * 5 ms = 395 ms).
+// Finally, the header of the slot is written (5 ms), this is the ACK, that all data was successfully written.
+// The resulting write time is at max 195 + 5 = 200 ms (single slot: 400 ms)
+// Just blocks, which differ between slot and current values (marked dirty per slot), are written,
+// so write time depends on the number of changes since this slot was written last.
+// Slot headers are the only validity information, the former magic word at address 12 of page 0 is not used anymore.
 // Bytes of the first page (page 0) might be used differently in future
-// For inputs, which are not set as "store in memory", we write a dpt 0xFF
-void Logic::writeAllDptToEEPROM()
+
+// calculates offset of each saved input and the hash of the layout, has to be called before
+// prepareChannels(), because channels restore their inputs from EEPROM.
+// Sizes are kept, so saving does not depend on parameters, which might change during ETS programming
+void Logic::prepareSaveLayout()
 {
+    uint16_t lOffset = 0;
+    uint16_t lSkipped = 0;
+    uint32_t lHash = 2166136261UL; // FNV-1a
+    for (uint8_t lChannelId = 0; lChannelId < mNumChannels; lChannelId++)
+    {
+        mSaveOffset[lChannelId] = lOffset;
+        mSaveSizes[lChannelId] = 0;
+        for (uint8_t lIOIndex = IO_Input1; lIOIndex <= IO_Input2; lIOIndex++)
+        {
+            uint8_t lDpt;
+            uint8_t lSize = mChannel[lChannelId]->getSaveLayout(lIOIndex, lDpt);
+            if (lSize == 0)
+                continue;
+            // values have to fit into one snapshot slot, a single slot spans all pages
+            if (lOffset + lSize > SAVE_SINGLE_SLOT_DATA_SIZE)
+            {
+                lSkipped++;
+                continue;
+            }
+            uint8_t lData[4] = {lChannelId, lIOIndex, lDpt, lSize};
+            for (uint8_t lIndex = 0; lIndex < 4; lIndex++)
+                lHash = (lHash ^ lData[lIndex]) * 16777619UL;
+            mSaveSizes[lChannelId] |= lSize << ((lIOIndex - 1) * 4);
+            lOffset += lSize;
+        }
+    }
+    mSaveLayoutHash = lHash;
+    mSaveSize = lOffset;
+    mSaveSingleSlot = (lOffset > SAVE_SLOT_DATA_SIZE);
+    printDebug("Save layout: %d bytes, hash %08lX\n", lOffset, mSaveLayoutHash);
+    if (mSaveSingleSlot)
+        printDebug("WARNING: %d bytes of saved inputs exceed %d bytes of a snapshot slot, just one slot is used, an interrupted save invalidates all saved inputs!\n", lOffset, SAVE_SLOT_DATA_SIZE);
+    if (lSkipped > 0)
+        printDebug("WARNING: %d inputs exceed %d bytes of EEPROM snapshot and are not saved!\n", lSkipped, SAVE_SINGLE_SLOT_DATA_SIZE);
+}
+
+// slot written by next save: the one without newest snapshot, or slot A, if there is a single slot
+uint8_t Logic::getSaveTargetSlot()
+{
+    return mSaveSingleSlot ? 0 : 1 - mSaveSlot;
+}
+
+// reads header of a snapshot slot, returns true, if it belongs to current layout
+bool Logic::readSaveHeader(uint8_t iSlot, sSaveHeader &cHeader)
+{
+    uint8_t *lHeader = (uint8_t *)&cHeader;
+    prepareEEPROMRead(SAVE_SLOT_ADDRESS(iSlot), sizeof(sSaveHeader));
+    for (uint8_t lIndex = 0; lIndex < sizeof(sSaveHeader); lIndex++)
+        lHeader[lIndex] = Wire.available() ? Wire.read() : 0xFF;
+    return memcmp(cHeader.magic, sMagicWord, 4) == 0 && cHeader.layoutHash == mSaveLayoutHash;
+}
+
+// reads values of a snapshot slot and returns their CRC. Values are stored in restore buffer or,
+// if iCompare is set, compared to it: blocks with different values are marked dirty for this slot
+uint32_t Logic::readSaveSlot(uint8_t iSlot, uint32_t iSequence, bool iCompare)
+{
+    uint32_t lCrc = calculateCrc(0xFFFFFFFF, (uint8_t *)&iSequence, 4);
+    uint16_t lOffset = 0;
+    while (lOffset < mSaveSize)
+    {
+        // 32 bytes fit into i2c buffer
+        uint8_t lLength = (mSaveSize - lOffset > 32) ? 32 : mSaveSize - lOffset;
+        prepareEEPROMRead(SAVE_SLOT_ADDRESS(iSlot) + SAVE_SLOT_HEADER_SIZE + lOffset, lLength);
+        for (uint8_t lIndex = 0; lIndex < lLength; lIndex++, lOffset++)
+        {
+            uint8_t lByte = Wire.available() ? Wire.read() : 0xFF;
+            lCrc = calculateCrc(lCrc, &lByte, 1);
+            if (!iCompare)
+                mRestoreBuffer[lOffset] = lByte;
+            else if (lByte != mRestoreBuffer[lOffset])
+                mDirtyBlocks[iSlot][lOffset / 128] |= 1 << ((lOffset / 16) % 8);
+        }
+    }
+    return ~lCrc;
+}
+
+// CRC-32 (IEEE 802.3), has to be started with 0xFFFFFFFF, final result is inverted
+uint32_t Logic::calculateCrc(uint32_t iCrc, uint8_t *iData, uint16_t iLength)
+{
+    for (uint16_t lIndex = 0; lIndex < iLength; lIndex++)
+    {
+        iCrc ^= iData[lIndex];
+        for (uint8_t lBit = 0; lBit < 8; lBit++)
+            iCrc = (iCrc >> 1) ^ (0xEDB88320UL & (0 - (iCrc & 1)));
+    }
+    return iCrc;
+}
+
+// selects the newest valid snapshot and reads its values in few sequential reads into a buffer,
+// channels restore their inputs from it. The buffer is just needed during startup, it is freed by freeRestoreBuffer()
+void Logic::loadRestoreBuffer()
+{
+    // without a valid snapshot, all values have to be written to both slots, first to slot A
+    markAllInputsDirty();
+    mSaveSlot = 1;
+    mSaveSequence = 0;
 #ifdef I2C_EEPROM_DEVICE_ADDRESSS
-    if (mLastWriteToEEPROM > 0 && delayCheck(mLastWriteToEEPROM, 10000))
+    if (mSaveSize == 0)
+        return;
+    uint32_t lStart = millis();
+    sSaveHeader lHeader[2];
+    bool lValid[2] = {false, false};
+    // with a single slot, there is no header of slot B, its address contains values of slot A
+    for (uint8_t lSlot = 0; lSlot < (mSaveSingleSlot ? 1 : 2); lSlot++)
+        lValid[lSlot] = readSaveHeader(lSlot, lHeader[lSlot]);
+    // newest snapshot first, if its CRC does not fit (save was interrupted), the older one is used
+    uint8_t lSlot = (lValid[1] && (!lValid[0] || (int32_t)(lHeader[1].sequence - lHeader[0].sequence) > 0)) ? 1 : 0;
+    mRestoreBuffer = new uint8_t[mSaveSize];
+    for (uint8_t lTry = 0; lTry < 2; lTry++)
+    {
+        if (lValid[lSlot] && readSaveSlot(lSlot, lHeader[lSlot].sequence, false) == lHeader[lSlot].crc)
+            break;
+        lValid[lSlot] = false;
+        lSlot = 1 - lSlot;
+    }
+    if (!lValid[lSlot])
     {
-        println("writeAllDptToEEPROM called repeatedly within 10 seconds, skipped!");
+        printDebug("EEPROM does NOT contain valid data\n");
+        freeRestoreBuffer();
         return;
     }
-    mLastWriteToEEPROM = millis();
+    mSaveSlot = lSlot;
+    mSaveSequence = lHeader[lSlot].sequence;
+    memset(mDirtyBlocks[lSlot], 0, sizeof(mDirtyBlocks[lSlot]));
+    // the other slot just needs those blocks, which differ from the restored snapshot
+    uint8_t lOther = 1 - lSlot;
+    if (lValid[lOther])
+    {
+        memset(mDirtyBlocks[lOther], 0, sizeof(mDirtyBlocks[lOther]));
+        if (readSaveSlot(lOther, lHeader[lOther].sequence, true) != lHeader[lOther].crc)
+            markSlotDirty(lOther);
+    }
+    printDebug("EEPROM contains valid KO inputs in slot %c (sequence %lu), %d bytes read in %lu ms\n", 'A' + lSlot, mSaveSequence, mSaveSize, millis() - lStart);
+#endif
+}
 
-    // prepare initialization
-    uint16_t lAddress = (SAVE_BUFFER_START_PAGE + 1) * 32; // begin of DPT memory
-    // start writing all dpt. For inputs, which should not be saved, we write a dpt 0xFF
-    for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
+void Logic::freeRestoreBuffer()
+{
+    delete[] mRestoreBuffer;
+    mRestoreBuffer = nullptr;
+}
+
+// saved value of an input during startup, nullptr if there is no valid value
+uint8_t *Logic::getRestoreValue(uint8_t iChannelId, uint8_t iIOIndex)
+{
+    if (mRestoreBuffer == nullptr || getSaveSize(iChannelId, iIOIndex) == 0)
+        return nullptr;
+    return mRestoreBuffer + getSaveOffset(iChannelId, iIOIndex);
+}
+
+// number of bytes saved for an input, 0 if it is not saved
+uint8_t Logic::getSaveSize(uint8_t iChannelId, uint8_t iIOIndex)
+{
+    return (mSaveSizes[iChannelId] >> ((iIOIndex - 1) * 4)) & 0xF;
+}
+
+// offset of a saved input within the values of a snapshot slot, just valid for saved inputs
+uint16_t Logic::getSaveOffset(uint8_t iChannelId, uint8_t iIOIndex)
+{
+    uint16_t lOffset = mSaveOffset[iChannelId];
+    if (iIOIndex == IO_Input2)
+        lOffset += getSaveSize(iChannelId, IO_Input1);
+    return lOffset;
+}
+
+void Logic::markInputDirty(uint8_t iChannelId, uint8_t iIOIndex)
+{
+    uint16_t lOffset = getSaveOffset(iChannelId, iIOIndex);
+    uint16_t lLast = lOffset + getSaveSize(iChannelId, iIOIndex) - 1;
+    // a value might be split to 2 blocks, both slots differ from the new value
+    for (uint16_t lBlock = lOffset / 16; lBlock <= lLast / 16; lBlock++)
+        for (uint8_t lSlot = 0; lSlot < 2; lSlot++)
+            mDirtyBlocks[lSlot][lBlock / 8] |= 1 << (lBlock % 8);
+}
+
+// marks all used blocks of a slot dirty
+void Logic::markSlotDirty(uint8_t iSlot)
+{
+    for (uint16_t lBlock = 0; lBlock < (mSaveSize + 15) / 16; lBlock++)
+        mDirtyBlocks[iSlot][lBlock / 8] |= 1 << (lBlock % 8);
+}
+
+void Logic::markAllInputsDirty()
+{
+    markSlotDirty(0);
+    markSlotDirty(1);
+}
+
+// collects current values of all inputs within 16 byte block iBlock, returns number of used bytes
+uint8_t Logic::fillSaveBlock(uint16_t iBlock, uint8_t *cData)
+{
+    uint16_t lBlockStart = iBlock * 16;
+    uint16_t lBlockEnd = lBlockStart + 16;
+    for (uint8_t lChannelId = 0; lChannelId < mNumChannels && mSaveOffset[lChannelId] < lBlockEnd; lChannelId++)
     {
-        mEEPROM->beginPage(lAddress);
-        mChannel[lIndex]->writeSingleDptToEEPROM(IO_Input1);
-        lAddress++;
-        mChannel[lIndex]->writeSingleDptToEEPROM(IO_Input2);
-        lAddress++;
-        if (lAddress % 16 == 0)
-            mEEPROM->endPage();
+        uint16_t lOffset = mSaveOffset[lChannelId];
+        for (uint8_t lIOIndex = IO_Input1; lIOIndex <= IO_Input2; lIOIndex++)
+        {
+            uint8_t lSize = getSaveSize(lChannelId, lIOIndex);
+            if (lSize > 0 && lOffset + lSize > lBlockStart)
+            {
+                uint8_t *lValue = LogicChannel::getKoForChannel(lIOIndex, lChannelId)->valueRef();
+                for (uint8_t lIndex = 0; lIndex < lSize; lIndex++)
+                    if (lOffset + lIndex >= lBlockStart && lOffset + lIndex < lBlockEnd)
+                        cData[lOffset + lIndex - lBlockStart] = lValue[lIndex];
+            }
+            lOffset += lSize;
+        }
     }
-    mEEPROM->endPage();
+    return (mSaveSize >= lBlockEnd) ? 16 : mSaveSize - lBlockStart;
+}
+
+// one i2c page write, EEPROM is busy afterwards until the write cycle is finished
+void Logic::writeEEPROMPage(uint16_t iAddress, uint8_t *iData, uint8_t iLength)
+{
+#ifdef I2C_EEPROM_DEVICE_ADDRESSS
+    Wire.beginTransmission(I2C_EEPROM_DEVICE_ADDRESSS);
+    Wire.write((uint8_t)(iAddress >> 8));
+    Wire.write((uint8_t)(iAddress & 0xFF));
+    Wire.write(iData, iLength);
+    Wire.endTransmission();
 #endif
 }
 
-void Logic::writeAllInputsToEEPROM()
+// starts a sequential read of iLength bytes, they are fetched by Wire.read() afterwards
+void Logic::prepareEEPROMRead(uint16_t iAddress, uint8_t iLength)
+{
+#ifdef I2C_EEPROM_DEVICE_ADDRESSS
+    Wire.beginTransmission(I2C_EEPROM_DEVICE_ADDRESSS);
+    Wire.write((uint8_t)(iAddress >> 8));
+    Wire.write((uint8_t)(iAddress & 0xFF));
+    Wire.endTransmission();
+    Wire.requestFrom(I2C_EEPROM_DEVICE_ADDRESSS, iLength);
+#endif
+}
+
+// acknowledge polling: EEPROM does not answer its address during a write cycle
+bool Logic::isEEPROMReady()
 {
 #ifdef I2C_EEPROM_DEVICE_ADDRESSS
+    Wire.beginTransmission(I2C_EEPROM_DEVICE_ADDRESSS);
+    return Wire.endTransmission() == 0;
+#else
+    return true;
+#endif
+}
 
+// starts a save session, which writes one page per step. Returns false, if there is nothing to write
+bool Logic::startSave()
+{
+    if (mSaveState != ssIdle)
+        return true;
+    // if inactive slot does not differ from current values, it is written with next change
+    uint8_t lSlot = getSaveTargetSlot();
+    bool lDirty = false;
+    for (uint8_t lIndex = 0; lIndex < sizeof(mDirtyBlocks[lSlot]) && !lDirty; lIndex++)
+        lDirty = mDirtyBlocks[lSlot][lIndex];
+    if (!lDirty)
+        return false;
     if (mLastWriteToEEPROM > 0 && delayCheck(mLastWriteToEEPROM, 10000))
     {
         println("writeAllInputsToEEPROM called repeatedly within 10 seconds, skipped!");
-        return;
+        return false;
     }
     mLastWriteToEEPROM = millis();
+    mSaveStepTimestamp = millis();
+    mSaveState = ssValues;
+    mSaveBlock = 0;
+    return true;
+}
+
+// processes next step of a save session, each step writes at most one page and
+// has to wait until EEPROM finished the write cycle of the previous step.
+// Just the inactive slot is written, the newest snapshot stays valid until the header is written
+void Logic::processSaveStep()
+{
+    if (mSaveState == ssIdle)
+        return;
+    uint8_t lSlot = getSaveTargetSlot();
+    if (!isEEPROMReady())
+    {
+        // EEPROM does not acknowledge anymore, the session is aborted and the
+        // content of the inactive slot is unknown, so next save writes it completely
+        if (delayCheck(mSaveStepTimestamp, SAVE_ACK_TIMEOUT))
+        {
+            println("EEPROM does not acknowledge, save aborted!");
+            markSlotDirty(lSlot);
+            mSaveState = ssIdle;
+        }
+        return;
+    }
+    switch (mSaveState)
+    {
+        case ssValues: {
+            // next 16 byte block with changed inputs
+            uint16_t lNumBlocks = (mSaveSize + 15) / 16;
+            while (mSaveBlock < lNumBlocks && (mDirtyBlocks[lSlot][mSaveBlock / 8] & (1 << (mSaveBlock % 8))) == 0)
+                mSaveBlock++;
+            if (mSaveBlock >= lNumBlocks)
+            {
+                mSaveState = ssCommit;
+                break;
+            }
+            uint8_t lData[16];
+            uint8_t lLength = fillSaveBlock(mSaveBlock, lData);
+            mDirtyBlocks[lSlot][mSaveBlock / 8] &= ~(1 << (mSaveBlock % 8));
+            writeEEPROMPage(SAVE_SLOT_ADDRESS(lSlot) + SAVE_SLOT_HEADER_SIZE + mSaveBlock * 16, lData, lLength);
+            mSaveStepTimestamp = millis();
+            mSaveBlock++;
+            break;
+        }
+        case ssCommit: {
+            // a block changed again after writing is written before header, so CRC fits to slot content
+            for (uint8_t lIndex = 0; lIndex < sizeof(mDirtyBlocks[lSlot]); lIndex++)
+            {
+                if (mDirtyBlocks[lSlot][lIndex])
+                {
+                    mSaveState = ssValues;
+                    mSaveBlock = 0;
+                    return;
+                }
+            }
+            // as a last step we write the header with a new sequence,
+            // this is also the ACK, that writing was successfull
+            sSaveHeader lHeader;
+            memcpy(lHeader.magic, sMagicWord, 4);
+            lHeader.layoutHash = mSaveLayoutHash;
+            lHeader.sequence = mSaveSequence + 1;
+            uint32_t lCrc = calculateCrc(0xFFFFFFFF, (uint8_t *)&lHeader.sequence, 4);
+            for (uint16_t lBlock = 0; lBlock < (mSaveSize + 15) / 16; lBlock++)
+            {
+                uint8_t lData[16];
+                uint8_t lLength = fillSaveBlock(lBlock, lData);
+                lCrc = calculateCrc(lCrc, lData, lLength);
+            }
+            lHeader.crc = ~lCrc;
+            writeEEPROMPage(SAVE_SLOT_ADDRESS(lSlot), (uint8_t *)&lHeader, sizeof(sSaveHeader));
+            mSaveSlot = lSlot;
+            mSaveSequence = lHeader.sequence;
+            mSaveState = ssIdle;
+            break;
+        }
+        default:
+            break;
+    }
+}
 
-    // prepare initialization
-    mEEPROM->beginWriteSession();
-
-    //Begin write of KO values
-    uint16_t lAddress = (SAVE_BUFFER_START_PAGE + 9) * 32; // begin of KO value memory
-    // for (uint8_t i = 0; i < 10; i++)
-    for (uint8_t lChannel = 0; lChannel < mNumChannels; lChannel++)
-    {
-        mEEPROM->beginPage(lAddress);
-        GroupObject *lKo = LogicChannel::getKoForChannel(IO_Input1, lChannel);
-        mEEPROM->write4Bytes(lKo->valueRef(), lKo->valueSize());
-        lAddress += 4;
-        lKo = LogicChannel::getKoForChannel(IO_Input2, lChannel);
-        mEEPROM->write4Bytes(lKo->valueRef(), lKo->valueSize());
-        lAddress += 4;
-        if (lAddress % 16 == 0)
-            mEEPROM->endPage();
-    }
-    mEEPROM->endPage();
-
-    // as a last step we write magic number back
-    // this is also the ACK, that writing was successfull
-    mEEPROM->endWriteSession();
+// synchronous save for power failure and restart, also finishes a running asynchronous save
+void Logic::writeAllInputsToEEPROM()
+{
+#ifdef I2C_EEPROM_DEVICE_ADDRESSS
+    if (!startSave())
+        return;
+    while (mSaveState != ssIdle)
+    {
+        // wait for end of previous write cycle (max. 5 ms),
+        // processSaveStep() aborts, if EEPROM does not acknowledge within SAVE_ACK_TIMEOUT
+        uint32_t lWait = millis();
+        while (!isEEPROMReady() && !delayCheck(lWait, 10))
+            ;
+        processSaveStep();
+    }
+    // the last write cycle has to be finished before we continue
+    uint32_t lWait = millis();
+    while (!isEEPROMReady() && !delayCheck(lWait, 10))
+        ;
 #endif
 }
 
@@ -221,37 +786,14 @@ void Logic::writeAllInputsToEEPROMFacade() {
 // on input level, all dpt > 1 values are converted to bool by the according converter
 void Logic::processInputKo(GroupObject &iKo)
 {
-    if (iKo.asap() == LOG_KoTime) {
-        struct tm lTmp = iKo.value(getDPT(VAL_DPT_10));
-        sTimer.setTimeFromBus(&lTmp);
-    } else if (iKo.asap() == LOG_KoDate) {
-        struct tm lTmp = iKo.value(getDPT(VAL_DPT_11));
-        sTimer.setDateFromBus(&lTmp);
-    } else if (iKo.asap() == LOG_Diagnose) {
-        processDiagnoseCommand(iKo);
-    }
-#ifdef BUZZER_PIN
-    else if (iKo.asap() == LOG_KoBuzzerLock) {
-        // turn off buzzer in case of lock
-        if (iKo.value(getDPT(VAL_DPT_1)))
-            noTone(BUZZER_PIN);
-    }
-#endif
-#ifdef I2C_RGBLED_DEVICE_ADDRESS
-    else if (iKo.asap() == LOG_KoLedLock)
-    {
-        // turn off LED in case of lock
-        if (iKo.value(getDPT(VAL_DPT_1)))
-            PCA9632_SetColor(0, 0, 0);
-    }
-#endif
-    else if (iKo.asap() >= LOG_KoOffset && iKo.asap() < LOG_KoOffset + mNumChannels * LOG_KoBlockSize)
+    uint16_t lKoNumber = iKo.asap();
+    if (lKoNumber >= LOG_KoDispatchSize)
+        return;
+    sKoDispatch &lEntry = sKoDispatchTable[lKoNumber];
+    if (lEntry.callback)
     {
-        uint16_t lKoNumber = iKo.asap() - LOG_KoOffset;
-        uint8_t lChannelId = lKoNumber / LOG_KoBlockSize;
-        uint8_t lIOIndex = lKoNumber % LOG_KoBlockSize + 1;
-        LogicChannel *lChannel = mChannel[lChannelId];
-        lChannel->processInput(lIOIndex);
+        sKoCallbackParams &lCallback = sKoCallbacks[lEntry.callback - 1];
+        lCallback.callback(lCallback.instance, iKo, lEntry.channelId, lEntry.ioIndex);
     }
 }
 
@@ -401,22 +943,6 @@ void Logic::beforeRestartHandler()
     writeAllInputsToEEPROMFacade();
 }
 
-void Logic::beforeTableUnloadHandler(TableObject & iTableObject, LoadState & iNewState)
-{
-    static uint32_t sLastCalled = 0;
-    printDebug("Table changed called with state %d\n", iNewState);
-
-    if (iNewState == 0)
-    {
-        printDebug("Table unload called\n");
-        if (sLastCalled == 0 || delayCheck(sLastCalled, 10000))
-        {
-            writeAllInputsToEEPROMFacade();
-            sLastCalled = millis();
-        }
-    }
-}
-
 void Logic::debug() {
     printDebug("Logik-LOG_ChannelsFirmware (in Firmware): %d\n", LOG_ChannelsFirmware);
     printDebug("Logik-gNumChannels (in knxprod):  %d\n", mNumChannels);
@@ -453,23 +979,22 @@ void Logic::setup(bool iSaveSupported) {
             sprintf(lErrorText, "FATAL: Firmware compiled for %d channels, but knxprod needs %d channels!\n", LOG_ChannelsFirmware, mNumChannels);
             fatalError(FATAL_LOG_WRONG_CHANNEL_COUNT, lErrorText);
         }
+        setupChannelState();
         for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
         {
-            mChannel[lIndex] = new LogicChannel(lIndex);
+            mChannel[lIndex] = new (&sChannelPool[lIndex * sizeof(LogicChannel)]) LogicChannel(lIndex);
         }
-        // this should be changed if we ever use multiple instances of logic
-        mEEPROM = new EepromManager(SAVE_BUFFER_START_PAGE, SAVE_BUFFER_NUM_PAGES, sMagicWord);
+        // all channel delays are handled by one timing wheel
+        sTimingWheel.setup(mNumChannels * DLY_COUNT, onDelayExpiredHandler);
+        printDebug("Logic RAM per channel: %d bytes (channel %d, state %d, delays %d)\n",
+                   sizeof(LogicChannel) + LOG_StateBytesPerChannel + DLY_COUNT * (2 * sizeof(uint16_t) + sizeof(uint32_t)),
+                   sizeof(LogicChannel), LOG_StateBytesPerChannel, DLY_COUNT * (2 * sizeof(uint16_t) + sizeof(uint32_t)));
         // setup buzzer
 #ifdef BUZZER_PIN
         pinMode(BUZZER_PIN, OUTPUT);
 #endif
         // we set just a callback if it is not set from a potential caller
         if (GroupObject::classCallback() == 0) GroupObject::classCallback(Logic::onInputKoHandler);
-        if (mEEPROM->isValid()) {
-            printDebug("EEPROM contains valid KO inputs\n");
-        } else {
-            printDebug("EEPROM does NOT contain valid data\n");
-        }
         // we store some input values in case of restart or ets programming
         if (knx.getBeforeRestartCallback() == 0) knx.addBeforeRestartCallback(onBeforeRestartHandler);
         if (TableObject::getBeforeTableUnloadCallback() == 0) TableObject::addBeforeTableUnloadCallback(onBeforeTableUnloadHandler);
@@ -479,8 +1004,13 @@ void Logic::setup(bool iSaveSupported) {
             attachInterrupt(digitalPinToInterrupt(SAVE_INTERRUPT_PIN), onSafePinInterruptHandler, FALLING);
         }
 #endif
+        prepareSaveLayout();
+        loadRestoreBuffer();
         if (prepareChannels())
-            writeAllDptToEEPROM();
+            markAllInputsDirty();
+        freeRestoreBuffer();
+        prepareInternalInputs();
+        prepareKoDispatch();
         float lLat = LogicChannel::getFloat(knx.paramData(LOG_Latitude));
         float lLon = LogicChannel::getFloat(knx.paramData(LOG_Longitude));
         // sTimer.setup(8.639751, 49.310209, 1, true, 0xFFFFFFFF);
@@ -498,6 +1028,10 @@ void Logic::setup(bool iSaveSupported) {
 
 void Logic::loop()
 {
+    // pending EEPROM writes, a save started by ETS programming continues while device is not configured
+    processSaveStep();
+    if (!knx.configured())
+        return;
 #ifdef WATCHDOG
     if (delayCheck(gWatchdogDelay, 1000) && ((knx.paramByte(LOG_Watchdog) & LOG_WatchdogMask) >> LOG_WatchdogShift))
     {
@@ -505,20 +1039,26 @@ void Logic::loop()
         gWatchdogDelay = millis();
     }
 #endif
-    if (!knx.configured())
-        return;
 
     processInterrupt();
     sTimer.loop(); // clock and timer async methods
+    sTimingWheel.loop(); // expired delays queue their channels
     loopSubmodules();
 
-    // we loop on all channels and execute pipeline
-    for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
+    // timer channels, which might switch now, are queued once a minute
+    if (sTimer.minuteChanged())
+        processTimerHeap();
+    processLogicBatch();
+    // we loop just on channels with pending work and execute pipeline,
+    // idle channels do not cost anything here
+    for (uint8_t lIndex = 0; lIndex < mNumReady;)
     {
-        LogicChannel *lChannel = mChannel[lIndex];
-        if (sTimer.minuteChanged())
-            lChannel->startTimerInput();
+        LogicChannel *lChannel = mChannel[mReadyQueue[lIndex]];
         lChannel->loop();
+        if (lChannel->hasPendingWork())
+            lIndex++;
+        else
+            removeFromReadyQueue(lIndex); // the former last entry is processed next
         loopSubmodules();
     }
     if (sTimer.minuteChanged()) {
@@ -529,41 +1069,112 @@ void Logic::loop()
     processTimerRestore();
 }
 
-EepromManager *Logic::getEEPROM() {
-    return mEEPROM;
+// all timer channels get their next switch minute, used on day change and whenever time jumped
+void Logic::buildTimerHeap(uint16_t iMinute)
+{
+    mNumTimerHeap = 0;
+    for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
+    {
+        if (mChannel[lIndex]->isTimerChannel())
+        {
+            mTimerNextMinute[lIndex] = mChannel[lIndex]->getNextTimerMinute(iMinute);
+            mTimerHeap[mNumTimerHeap++] = lIndex;
+        }
+    }
+    for (uint8_t lIndex = mNumTimerHeap / 2; lIndex > 0; lIndex--)
+        siftDownTimerHeap(lIndex - 1);
+}
+
+void Logic::siftDownTimerHeap(uint8_t iIndex)
+{
+    uint8_t lChannelId = mTimerHeap[iIndex];
+    uint16_t lMinute = mTimerNextMinute[lChannelId];
+    while (2 * iIndex + 1 < mNumTimerHeap)
+    {
+        uint8_t lChild = 2 * iIndex + 1;
+        if (lChild + 1 < mNumTimerHeap && mTimerNextMinute[mTimerHeap[lChild + 1]] < mTimerNextMinute[mTimerHeap[lChild]])
+            lChild++;
+        if (mTimerNextMinute[mTimerHeap[lChild]] >= lMinute)
+            break;
+        mTimerHeap[iIndex] = mTimerHeap[lChild];
+        iIndex = lChild;
+    }
+    mTimerHeap[iIndex] = lChannelId;
+}
+
+// called once a minute, just timer channels due now are evaluated
+void Logic::processTimerHeap()
+{
+    if (!sTimer.isTimerValid())
+        return;
+#ifdef LOGIC_TIMER_SCAN
+    // reference for host regression runs: all timer channels are evaluated each minute
+    for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
+        mChannel[lIndex]->startTimerInput();
+    return;
+#endif
+    uint16_t lMinute = sTimer.getHour() * 60 + sTimer.getMinute();
+    bool lVacation = knx.getGroupObject(LOG_KoVacation).value(getDPT(VAL_DPT_1));
+    // new day data, time set from bus or vacation change invalidate all switch minutes
+    if (sTimer.dayChanged() || lMinute != mTimerHeapMinute + 1 || lVacation != mTimerHeapVacation)
+        buildTimerHeap(lMinute);
+    sTimer.clearDayChanged();
+    mTimerHeapMinute = lMinute;
+    mTimerHeapVacation = lVacation;
+    while (mNumTimerHeap > 0 && mTimerNextMinute[mTimerHeap[0]] <= lMinute)
+    {
+        uint8_t lChannelId = mTimerHeap[0];
+        mChannel[lChannelId]->startTimerInput();
+        mTimerNextMinute[lChannelId] = mChannel[lChannelId]->getNextTimerMinute(lMinute + 1);
+        siftDownTimerHeap(0);
+    }
 }
 
 // start timer implementation
+// all timer channels are restored in one pass as soon as time is valid: days are
+// checked backwards until each channel found its last switching time (max. one year)
 void Logic::processTimerRestore() {
-    static uint32_t sTimerRestoreDelay = 1;
-    if (sTimerRestoreDelay == 0)
+    static bool sTimerRestoreDone = false;
+    if (sTimerRestoreDone || sTimer.isTimerValid() != tmValid)
         return;
-    if (sTimer.isTimerValid() == tmValid && delayCheck(sTimerRestoreDelay, 500)) {
-        sTimerRestoreDelay = millis();
-        if (sTimerRestoreDelay == 0)
-            sTimerRestoreDelay = 1; // prevent set to 0 in case of timer overflow
-        if (sTimerRestore.getDayIteration() < 365) {
-            if (sTimerRestore.getDayIteration() == 0)
-            {
-                // initialize RestoreTimer
-                sTimerRestore.setup(sTimer);
-            }
-            else
-            {
-                sTimerRestore.decreaseDay();
-            }
-            loopSubmodules();
-        } else {
-            // stop timer restore processing in logic...
-            sTimerRestoreDelay = 0;
-            // ... and in each channel
-            for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
+    sTimerRestoreDone = true;
+
+    bool lPending[LOG_ChannelsFirmware];
+    uint8_t lNumPending = 0;
+    for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
+    {
+        lPending[lIndex] = mChannel[lIndex]->isTimerRestorePending();
+        if (lPending[lIndex])
+            lNumPending++;
+    }
+    if (lNumPending == 0)
+        return;
+    uint32_t lStart = millis();
+    sTimerRestore.setup(sTimer);
+    while (lNumPending > 0)
+    {
+        for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
+        {
+            if (lPending[lIndex] && mChannel[lIndex]->processTimerRestoreDay(sTimerRestore))
             {
-                LogicChannel *lChannel = mChannel[lIndex];
-                lChannel->stopTimerRestoreState();
+                lPending[lIndex] = false;
+                lNumPending--;
             }
         }
+        if (sTimerRestore.getDayIteration() >= 365)
+            break;
+        sTimerRestore.decreaseDay();
+        // a replay of many days must not starve knx stack and submodules
+        loopSubmodules();
+    }
+    // stop timer restore processing in each channel
+    for (uint8_t lIndex = 0; lIndex < mNumChannels; lIndex++)
+    {
+        LogicChannel *lChannel = mChannel[lIndex];
+        lChannel->stopTimerRestoreState();
     }
+    printDebug("TimerRestore: %d days checked in %lu ms\n", sTimerRestore.getDayIteration(), millis() - lStart);
+    loopSubmodules();
 }
 
 // send holiday information on bus
@@ -2,6 +2,7 @@
 #include "LogicChannel.h"
 #include "Timer.h"
 #include "TimerRestore.h"
+#include "TimingWheel.h"
 
 // Watchdog reset causees
 #define WDT_RCAUSE_SYSTEM 6   // reset by system itself
@@ -9,12 +10,53 @@
 #define WDT_RCAUSE_EXT 4      // reset by reset signal
 #define WDT_RCAUSE_POR 0      // power on reset
 
+// bit planes for batch evaluation hold 32 channels per word
+#define LOGIC_BATCH_WORDS ((LOG_ChannelsFirmware + 31) / 32)
+
 typedef void (*loopCallback)(void *iThis);
 struct sLoopCallbackParams {
     loopCallback callback;
     void *instance;
 };
 
+// dispatch table for incoming telegrams is indexed by KO number,
+// modules including logic may define a larger size for their own KO
+#ifndef LOG_KoDispatchSize
+#define LOG_KoDispatchSize (LOG_KoOffset + LOG_ChannelsFirmware * LOG_KoBlockSize)
+#endif
+#define LOG_KoCallbacksMax 12
+
+typedef void (*koCallback)(void *iThis, GroupObject &iKo, uint8_t iChannelId, uint8_t iIOIndex);
+struct sKoCallbackParams {
+    koCallback callback;
+    void *instance;
+};
+struct sKoDispatch {
+    uint8_t callback; // index + 1 in callback list, 0 = KO is not handled
+    uint8_t channelId;
+    uint8_t ioIndex;
+};
+
+// max. time in ms to wait for acknowledge of EEPROM after a page write (write cycle takes max. 5 ms)
+#define SAVE_ACK_TIMEOUT 20
+
+// steps of writing saved inputs to EEPROM, each step writes at most one page
+enum eSaveState
+{
+    ssIdle,
+    ssValues, // write changed value blocks to inactive slot
+    ssCommit  // write slot header
+};
+
+// header of a snapshot slot, written after all values of the slot
+struct sSaveHeader
+{
+    uint8_t magic[4];
+    uint32_t layoutHash;
+    uint32_t sequence; // incremented with each save, the slot with higher sequence is newer
+    uint32_t crc;      // CRC-32 of sequence and values
+};
+
 class Logic
 {
   public:
@@ -26,17 +68,24 @@ class Logic
     static void onBeforeRestartHandler();
     static void onBeforeTableUnloadHandler(TableObject & iTableObject, LoadState & iNewState);
     static void onSafePinInterruptHandler();
+    static void onDelayExpiredHandler(uint16_t iTimerId);
     static char *initDiagnose(GroupObject &iKo);
     static char *getDiagnoseBuffer();
     static void addLoopCallback(loopCallback iLoopCallback, void *iThis);
+    static void addKoCallback(uint16_t iKoNumber, koCallback iKoCallback, void *iThis, uint8_t iChannelId = 0, uint8_t iIOIndex = 0);
 
     // instance
-    EepromManager *getEEPROM();
+    uint8_t *getRestoreValue(uint8_t iChannelId, uint8_t iIOIndex);
+    uint16_t getSaveOffset(uint8_t iChannelId, uint8_t iIOIndex);
+    uint8_t getSaveSize(uint8_t iChannelId, uint8_t iIOIndex);
     void writeAllInputsToEEPROMFacade();
     void processAllInternalInputs(LogicChannel *iChannel, bool iValue);
     void processReadRequests();
     void processInputKo(GroupObject &iKo);
     void processInterrupt(bool iForce = false);
+    void enqueueChannel(uint8_t iChannelId);
+    void addToLogicBatch(uint8_t iChannelId, uint8_t iLogic, uint8_t iActiveInputs, bool iCalculateInvalid);
+    void updateLogicBatch(uint8_t iChannelId, uint8_t iCurrentIn, uint8_t iValidActiveIO);
     bool processDiagnoseCommand();
     void outputDiagnose(GroupObject &iKo);
     void debug();
@@ -47,29 +96,106 @@ class Logic
     static uint8_t sMagicWord[];
     static Timer &sTimer;
     static TimerRestore &sTimerRestore;
+    static TimingWheel &sTimingWheel;
     static char sDiagnoseBuffer[16];
     static sLoopCallbackParams sLoopCallbacks[5];
     static uint8_t sNumLoopCallbacks;
+    static sKoCallbackParams sKoCallbacks[LOG_KoCallbacksMax];
+    static uint8_t sNumKoCallbacks;
+    static sKoDispatch sKoDispatchTable[LOG_KoDispatchSize];
+
+    // KO handlers registered in dispatch table
+    static void onTimeKoHandler(void *iThis, GroupObject &iKo, uint8_t iChannelId, uint8_t iIOIndex);
+    static void onDateKoHandler(void *iThis, GroupObject &iKo, uint8_t iChannelId, uint8_t iIOIndex);
+    static void onDiagnoseKoHandler(void *iThis, GroupObject &iKo, uint8_t iChannelId, uint8_t iIOIndex);
+    static void onLockKoHandler(void *iThis, GroupObject &iKo, uint8_t iChannelId, uint8_t iIOIndex);
+    static void onChannelInputKoHandler(void *iThis, GroupObject &iKo, uint8_t iChannelId, uint8_t iIOIndex);
+
+    // channels are constructed in a static pool instead of heap
+    alignas(LogicChannel) static uint8_t sChannelPool[LOG_ChannelsFirmware * sizeof(LogicChannel)];
+    // runtime state of all channels, one contiguous array per field, each sized to mNumChannels
+    static uint32_t sStatePool[(LOG_ChannelsFirmware * LOG_StateBytesPerChannel + 3) / 4];
 
     LogicChannel *mChannel[LOG_ChannelsFirmware];
     uint8_t mNumChannels; // Number of channels defined in knxprod
+    sChannelState mState;
+    // ready queue: just channels with pending pipeline steps are processed in loop()
+    uint8_t mReadyQueue[LOG_ChannelsFirmware];
+    uint8_t mReadyFlags[(LOG_ChannelsFirmware + 7) / 8] = {0};
+    uint8_t mNumReady = 0;
+    // fan-out index for internal inputs: subscribers of channel n are
+    // mInternalInputs[mInternalInputStart[n]] to mInternalInputs[mInternalInputStart[n + 1] - 1],
+    // each entry is (target channel << 1) | 1 for internal input 2
+    uint16_t mInternalInputStart[LOG_ChannelsFirmware + 1] = {0};
+    uint16_t mInternalInputs[2 * LOG_ChannelsFirmware];
+    // bit-sliced state of all AND, OR and EXOR channels, bit n of word w belongs to channel 32 * w + n,
+    // there is one bit plane per input (E1, E2, I1, I2)
+    uint32_t mBatchInput[4][LOGIC_BATCH_WORDS] = {{0}};
+    uint32_t mBatchValid[4][LOGIC_BATCH_WORDS] = {{0}};
+    uint32_t mBatchActive[4][LOGIC_BATCH_WORDS] = {{0}};
+    uint32_t mBatchAnd[LOGIC_BATCH_WORDS] = {0};
+    uint32_t mBatchOr[LOGIC_BATCH_WORDS] = {0};
+    uint32_t mBatchExOr[LOGIC_BATCH_WORDS] = {0};
+    uint32_t mBatchCalculateInvalid[LOGIC_BATCH_WORDS] = {0}; // evaluate also with invalid inputs
+    uint32_t mBatchDirty[LOGIC_BATCH_WORDS] = {0};            // changed inputs, waiting for evaluation
+    // min-heap of timer channels, ordered by the minute of day they might switch next
+    uint8_t mTimerHeap[LOG_ChannelsFirmware];
+    uint16_t mTimerNextMinute[LOG_ChannelsFirmware]; // indexed by channel id
+    uint8_t mNumTimerHeap = 0;
+    uint16_t mTimerHeapMinute = 0xFFFE; // minute of day processed last, heap is built on first call
+    bool mTimerHeapVacation = false;
     uint32_t mSaveInterruptTimestamp = 0;
     uint16_t mSaveInterruptCount = 0;
 
     uint32_t mLastWriteToEEPROM = 0;
+    // packed layout of inputs stored in EEPROM, offset of first saved input of each channel
+    uint16_t mSaveOffset[LOG_ChannelsFirmware];
+    uint8_t mSaveSizes[LOG_ChannelsFirmware]; // saved bytes of input 1 (bit 0-3) and input 2 (bit 4-7)
+    uint32_t mSaveLayoutHash = 0;
+    uint16_t mSaveSize = 0;           // bytes of all saved inputs
+    uint8_t *mRestoreBuffer = nullptr; // all saved values, just allocated during startup
+    uint8_t mSaveSlot = 1;             // slot of newest valid snapshot, next save writes the other one
+    bool mSaveSingleSlot = false;      // saved inputs exceed one of 2 slots, slot A spans all pages and is always written
+    uint32_t mSaveSequence = 0;        // sequence of newest valid snapshot
+    // per slot: bit n is set, if 16 byte block n of the slot differs from current input values
+    uint8_t mDirtyBlocks[2][(SAVE_VALUE_BLOCKS + 7) / 8] = {{0}};
+    eSaveState mSaveState = ssIdle;
+    uint16_t mSaveBlock = 0; // next block to check during ssValues
+    uint32_t mSaveStepTimestamp = 0; // start of last page write, EEPROM has to acknowledge within SAVE_ACK_TIMEOUT
     bool mIsValidEEPROM = false;
-    EepromManager *mEEPROM;
 
     LogicChannel *getChannel(uint8_t iChannelId);
-    uint8_t getChannelId(LogicChannel *iChannel);
+    void setupChannelState();
     bool prepareChannels();
+    void prepareInternalInputs();
+    void prepareKoDispatch();
+    void invalidateChannelParams();
+    void prepareSaveLayout();
+    void loadRestoreBuffer();
+    void freeRestoreBuffer();
+    void markInputDirty(uint8_t iChannelId, uint8_t iIOIndex);
+    void markSlotDirty(uint8_t iSlot);
+    void markAllInputsDirty();
+    uint8_t getSaveTargetSlot();
+    bool readSaveHeader(uint8_t iSlot, sSaveHeader &cHeader);
+    uint32_t readSaveSlot(uint8_t iSlot, uint32_t iSequence, bool iCompare);
+    static uint32_t calculateCrc(uint32_t iCrc, uint8_t *iData, uint16_t iLength);
+    void removeFromReadyQueue(uint8_t iQueueIndex);
+    void processLogicBatch();
+    void buildTimerHeap(uint16_t iMinute);
+    void siftDownTimerHeap(uint8_t iIndex);
+    void processTimerHeap();
 
-    void writeAllDptToEEPROM();
+    uint8_t fillSaveBlock(uint16_t iBlock, uint8_t *cData);
+    void prepareEEPROMRead(uint16_t iAddress, uint8_t iLength);
+    void writeEEPROMPage(uint16_t iAddress, uint8_t *iData, uint8_t iLength);
+    bool isEEPROMReady();
+    bool startSave();
+    void processSaveStep();
     void writeAllInputsToEEPROM();
 
     void onSavePinInterruptHandler();
     void beforeRestartHandler();
-    void beforeTableUnloadHandler(TableObject &iTableObject, LoadState &iNewState);
     void processDiagnoseCommand(GroupObject &iKo);
 
     void processTime();
@@ -6,8 +6,12 @@
 #include "LogicFunction.h"
 
 Logic *LogicChannel::sLogic = nullptr;
+sChannelState *LogicChannel::sState = nullptr;
 Timer &LogicChannel::sTimer = Timer::instance();
 TimerRestore &LogicChannel::sTimerRestore = TimerRestore::instance(); // singleton
+TimingWheel &LogicChannel::sTimingWheel = TimingWheel::instance(); // singleton
+// pipeline steps waiting for a delay, in order of DLY_*
+const uint32_t LogicChannel::cDelayPipeline[DLY_COUNT] = {PIP_STARTUP | PIP_ON_DELAY, PIP_OFF_DELAY, PIP_STAIRLIGHT, PIP_BLINK, PIP_ON_REPEAT | PIP_OFF_REPEAT, PIP_REPEAT_INPUT1, PIP_REPEAT_INPUT2};
 #if LOGIC_TRACE
 char LogicChannel::sFilter[30] = "";
 #endif
@@ -19,11 +23,16 @@ LogicChannel::LogicChannel(uint8_t iChannelNumber)
 {
     mChannelId = iChannelNumber;
     // initialize most important runtime field
-    pCurrentPipeline = 0;
-    pValidActiveIO = 0;
-    pTriggerIO = 0;
-    pCurrentIn = 0;
-    pCurrentOut = 0;
+    pCurrentPipeline() = 0;
+    pValidActiveIO() = 0;
+    pTriggerIO() = 0;
+    pCurrentIn() = 0;
+    pCurrentOut() = 0;
+    pCurrentIODebug() = 0;
+    pExpiredDelays() = 0;
+    mParamsValid = false;
+    mTimerProgram = nullptr;
+    mLogicKernel = &LogicChannel::logicInvalid;
 }
 
 LogicChannel::~LogicChannel()
@@ -139,6 +148,121 @@ uint8_t *LogicChannel::getStringParam(uint16_t iParamIndex)
     return knx.paramData(lIndex);
 }
 
+// all parameters used in pipeline are read just once from parameter memory
+void LogicChannel::decodeParams()
+{
+    mParams.inputRepeat[0] = getIntParam(LOG_fE1Repeat) * 1000;
+    mParams.inputRepeat[1] = getIntParam(LOG_fE2Repeat) * 1000;
+    mParams.stairlightTime = getIntParam(LOG_fOTime) * cTimeFactors[getByteParam(LOG_fOTimeBase)];
+    mParams.blinkTime = getIntParam(LOG_fOBlink) * 100;
+    mParams.onDelay = getIntParam(LOG_fODelayOn) * 100;
+    mParams.offDelay = getIntParam(LOG_fODelayOff) * 100;
+    mParams.onRepeat = getIntParam(LOG_fORepeatOn) * 100;
+    mParams.offRepeat = getIntParam(LOG_fORepeatOff) * 100;
+    mParams.calculate = getByteParam(LOG_fCalculate);
+    mParams.logic = (mParams.calculate & LOG_fDisableMask) ? 0 : getByteParam(LOG_fLogic);
+    mParams.triggerInputs = getByteParam(LOG_fTrigger) & BIT_INPUT_MASK;
+    mParams.triggerFirstProcessing = getByteParam(LOG_fTrigger) & 0x30;
+    mParams.gateTriggerClose = getByteParam(LOG_fTriggerGateClose);
+    mParams.gateTriggerOpen = getByteParam(LOG_fTriggerGateOpen);
+    mParams.input[0] = getByteParam(LOG_fE1);
+    mParams.input[1] = getByteParam(LOG_fE2);
+    mParams.inputDpt[0] = getByteParam(LOG_fE1Dpt);
+    mParams.inputDpt[1] = getByteParam(LOG_fE2Dpt);
+    mParams.inputDefault[0] = getByteParam(LOG_fE1Default);
+    mParams.inputDefault[1] = getByteParam(LOG_fE2Default);
+    mParams.internalInput = getByteParam(LOG_fI1);
+    mParams.delay = getByteParam(LOG_fODelay);
+    mParams.stairlight = getByteParam(LOG_fOStair);
+    mParams.outputDpt = getByteParam(LOG_fODpt);
+    mParams.onOutput = getByteParam(LOG_fOOn);
+    mParams.offOutput = getByteParam(LOG_fOOff);
+    decodeConvertParams(IO_Input1);
+    decodeConvertParams(IO_Input2);
+    if (mParams.logic == VAL_Logic_Timer)
+        compileTimerProgram();
+    bindLogicKernel();
+    mParamsValid = true;
+}
+
+// converter bounds and value lists are read once from param memory,
+// so converting an input value needs just integer compares
+void LogicChannel::decodeConvertParams(uint8_t iIOIndex)
+{
+    uConvertParams &lParams = mParams.convert[iIOIndex - 1];
+    uint16_t lParamLow = (iIOIndex == 1) ? LOG_fE1LowDelta : LOG_fE2LowDelta;
+    uint8_t lConvert = mParams.input[iIOIndex - 1] >> LOG_fE1ConvertShift;
+    uint8_t lDpt = mParams.inputDpt[iIOIndex - 1];
+    lParams.valueMask = 0;
+    if (lDpt == VAL_DPT_2 || lDpt == VAL_DPT_17)
+    {
+        // DPT2 has 4 "Zwangsführung" values, DPT17 has 8 scenes (parametrized 1 based)
+        uint8_t lNumValues = (lDpt == VAL_DPT_2) ? 4 : 8;
+        uint8_t lOffset = (lDpt == VAL_DPT_17) ? 1 : 0;
+        for (uint8_t lIndex = 0; lIndex < lNumValues; lIndex++)
+        {
+            uint8_t lValue = getByteParam(lParamLow + lIndex) - lOffset;
+            if (lValue < 64)
+                lParams.valueMask |= (uint64_t)1 << lValue;
+        }
+        return;
+    }
+    switch (lConvert)
+    {
+        case VAL_InputConvert_Interval:
+        case VAL_InputConvert_Hysterese:
+            lParams.bound.low = getParamByDpt(lDpt, lParamLow + 0);
+            lParams.bound.high = getParamByDpt(lDpt, lParamLow + 4);
+            break;
+        case VAL_InputConvert_DeltaInterval:
+        case VAL_InputConvert_DeltaHysterese:
+            lParams.bound.low = getParamForDelta(lDpt, lParamLow + 0);
+            lParams.bound.high = getParamForDelta(lDpt, lParamLow + 4);
+            break;
+        case VAL_InputConvert_Values:
+            switch (lDpt)
+            {
+                case VAL_DPT_5:
+                case VAL_DPT_5001:
+                case VAL_DPT_6:
+                    // 7 values, unused last entry repeats the first one
+                    for (uint8_t lIndex = 0; lIndex < 7; lIndex++)
+                        lParams.byteValues[lIndex] = getByteParam(lParamLow + lIndex);
+                    lParams.byteValues[7] = lParams.byteValues[0];
+                    break;
+                case VAL_DPT_7:
+                case VAL_DPT_8:
+                    // 3 values, unused last entry repeats the first one
+                    for (uint8_t lIndex = 0; lIndex < 3; lIndex++)
+                        lParams.wordValues[lIndex] = getWordParam(lParamLow + lIndex * 2);
+                    lParams.wordValues[3] = lParams.wordValues[0];
+                    break;
+                default:
+                    lParams.bound.low = getParamByDpt(lDpt, lParamLow);
+                    break;
+            }
+            break;
+        case VAL_InputConvert_Constant:
+            lParams.bound.low = getParamByDpt(lDpt, lParamLow);
+            break;
+        default:
+            break;
+    }
+}
+
+// parameters are decoded again after they were invalidated by a table unload
+sChannelParams &LogicChannel::getParams()
+{
+    if (!mParamsValid)
+        decodeParams();
+    return mParams;
+}
+
+void LogicChannel::invalidateParams()
+{
+    mParamsValid = false;
+}
+
 /*******************************
  * ComObject helper
  * ****************************/
@@ -168,23 +292,20 @@ GroupObject *LogicChannel::getKo(uint8_t iIOIndex)
 
 Dpt &LogicChannel::getKoDPT(uint8_t iIOIndex)
 {
-    uint16_t lParamDpt;
+    uint8_t lDpt;
     switch (iIOIndex)
     {
         case IO_Input1:
-            lParamDpt = LOG_fE1Dpt;
-            break;
         case IO_Input2:
-            lParamDpt = LOG_fE2Dpt;
+            lDpt = getParams().inputDpt[iIOIndex - 1];
             break;
         case IO_Output:
-            lParamDpt = LOG_fODpt;
+            lDpt = getParams().outputDpt;
             break;
         default:
-            lParamDpt = 0;
+            lDpt = getByteParam(0);
             break;
     }
-    uint8_t lDpt = getByteParam(lParamDpt);
     return getDPT(lDpt);
 }
 
@@ -256,7 +377,7 @@ void LogicChannel::knxResetDevice(uint16_t iParamIndex)
 void LogicChannel::setRGBColor(uint16_t iParamIndex)
 {
 #ifdef I2C_RGBLED_DEVICE_ADDRESS
-    if ((getByteParam(LOG_fAlarm) & LOG_fAlarmMask) || !knx.getGroupObject(LOG_KoLedLock).value(getDPT(VAL_DPT_1)))
+    if ((getParams().calculate & LOG_fAlarmMask) || !knx.getGroupObject(LOG_KoLedLock).value(getDPT(VAL_DPT_1)))
     {
         uint32_t lRGBColor = getIntParam(iParamIndex);
         uint8_t lRed = lRGBColor >> 24;
@@ -298,7 +419,7 @@ void LogicChannel::setBuzzer(uint16_t iParamIndex)
 {
 #ifdef BUZZER_PIN
     // check for global lock and alarm
-    if ((getByteParam(LOG_fAlarm) & LOG_fAlarmMask) || !knx.getGroupObject(LOG_KoBuzzerLock).value(getDPT(VAL_DPT_1))) {
+    if ((getParams().calculate & LOG_fAlarmMask) || !knx.getGroupObject(LOG_KoBuzzerLock).value(getDPT(VAL_DPT_1))) {
         switch (getByteParam(iParamIndex))
         {
             case VAL_Buzzer_Off:
@@ -395,14 +516,14 @@ int32_t LogicChannel::getInputValue(uint8_t iIOIndex)
 {
     int32_t lValue = 0;
     // check for constant
-    uint16_t lParamIndex = (iIOIndex == 1) ? LOG_fE1Convert : LOG_fE2Convert;
-    uint8_t lConvert = (getByteParam(lParamIndex) & LOG_fE1ConvertMask) >> LOG_fE1ConvertShift;
-    lParamIndex = (iIOIndex == 1) ? LOG_fE1Dpt : LOG_fE2Dpt;
-    uint8_t lDpt = getByteParam(lParamIndex);
+    uint8_t lConvert = (getParams().input[iIOIndex - 1] & LOG_fE1ConvertMask) >> LOG_fE1ConvertShift;
+    uint8_t lDpt = getParams().inputDpt[iIOIndex - 1];
     if (lConvert == VAL_InputConvert_Constant) {
-        // input value is a constant stored in param memory
-        uint16_t lParamIndex = (iIOIndex == 1) ? LOG_fE1LowDelta : LOG_fE2LowDelta;
-        lValue = getParamByDpt(lDpt, lParamIndex);
+        // input value is a constant stored in param memory, DPT2 and DPT17 keep their value list decoded
+        if (lDpt == VAL_DPT_2 || lDpt == VAL_DPT_17)
+            lValue = getByteParam((iIOIndex == 1) ? LOG_fE1LowDelta : LOG_fE2LowDelta);
+        else
+            lValue = getParams().convert[iIOIndex - 1].bound.low;
     } else {
         GroupObject *lKo = getKo(iIOIndex);
         // based on dpt, we read the correct c type.
@@ -439,7 +560,7 @@ int32_t LogicChannel::getInputValue(uint8_t iIOIndex)
 
 void LogicChannel::writeConstantValue(uint16_t iParamIndex)
 {
-    uint8_t lDpt = getByteParam(LOG_fODpt);
+    uint8_t lDpt = getParams().outputDpt;
     switch (lDpt)
     {
         uint8_t lValueByte;
@@ -499,10 +620,9 @@ void LogicChannel::writeConstantValue(uint16_t iParamIndex)
 void LogicChannel::writeParameterValue(uint8_t iIOIndex)
 {
     int32_t lValueOrig = getInputValue(iIOIndex);
-    uint16_t lParamDpt = (iIOIndex == 1) ? LOG_fE1Dpt : LOG_fE2Dpt;
-    uint8_t lInputDpt = getByteParam(lParamDpt);
+    uint8_t lInputDpt = getParams().inputDpt[iIOIndex - 1];
     int32_t lValue = (lInputDpt == VAL_DPT_9) ? lValueOrig / 10 : lValueOrig;
-    uint8_t lDpt = getByteParam(LOG_fODpt);
+    uint8_t lDpt = getParams().outputDpt;
     lValue = (lDpt == VAL_DPT_9) ? lValueOrig : lValue;
     writeValue(lValue, lInputDpt);
 }
@@ -512,16 +632,16 @@ void LogicChannel::writeFunctionValue(uint16_t iParamIndex)
     uint8_t lFunction = getByteParam(iParamIndex);
     int32_t lE1 = getInputValue(BIT_EXT_INPUT_1);
     int32_t lE2 = getInputValue(BIT_EXT_INPUT_2);
-    uint8_t lDptE1 = getByteParam(LOG_fE1Dpt);
-    uint8_t lDptE2 = getByteParam(LOG_fE2Dpt);
-    uint8_t lDptOut = getByteParam(LOG_fODpt);
+    uint8_t lDptE1 = getParams().inputDpt[0];
+    uint8_t lDptE2 = getParams().inputDpt[1];
+    uint8_t lDptOut = getParams().outputDpt;
     int32_t lValue = LogicFunction::callFunction(lFunction, lDptE1, lE1, lDptE2, lE2, &lDptOut);
     writeValue(lValue, lDptOut);
 }
 
 void LogicChannel::writeValue(uint32_t iValue, uint8_t iDpt)
 {
-    uint8_t lDpt = getByteParam(LOG_fODpt);
+    uint8_t lDpt = getParams().outputDpt;
     bool lValueBool;
     uint8_t lValueByte;
     uint16_t lValueWord;
@@ -581,6 +701,70 @@ void LogicChannel::writeValue(uint32_t iValue, uint8_t iDpt)
 /********************************
  * Logic functions
  *******************************/
+// marks pipeline steps as pending and schedules this channel for the next loop
+void LogicChannel::startPipeline(uint32_t iPipelineSteps)
+{
+    pCurrentPipeline() |= iPipelineSteps;
+    sLogic->enqueueChannel(mChannelId);
+}
+
+// a channel without pending pipeline steps has nothing to do in loop()
+// pipeline steps waiting for a delay are pending as soon as the delay expired
+bool LogicChannel::hasPendingWork()
+{
+    if ((pCurrentPipeline() & PIP_RUNNING) == 0)
+        // before channel is running, just startup is processed
+        return (pExpiredDelays() & (1 << DLY_STARTUP));
+    // timer restore is done by logic for all channels at once
+    return pExpiredDelays() || (pCurrentPipeline() & ~(PIP_RUNNING | PIP_WAIT_FOR_DELAY | PIP_TIMER_RESTORE_STATE));
+}
+
+// starts (or restarts) a delay, expiry is reported by timing wheel
+void LogicChannel::startDelay(uint8_t iDelay, uint32_t iDuration)
+{
+    if (iDuration == 0)
+    {
+        // a delay without duration is expired immediately
+        sTimingWheel.stop(mChannelId * DLY_COUNT + iDelay);
+        pExpiredDelays() |= (1 << iDelay);
+        sLogic->enqueueChannel(mChannelId);
+    }
+    else
+    {
+        pExpiredDelays() &= ~(1 << iDelay);
+        sTimingWheel.start(mChannelId * DLY_COUNT + iDelay, iDuration);
+    }
+}
+
+void LogicChannel::stopDelay(uint8_t iDelay)
+{
+    pExpiredDelays() &= ~(1 << iDelay);
+    sTimingWheel.stop(mChannelId * DLY_COUNT + iDelay);
+}
+
+uint32_t LogicChannel::getDelayRemaining(uint8_t iDelay)
+{
+    return sTimingWheel.remaining(mChannelId * DLY_COUNT + iDelay);
+}
+
+// returns true once, if the delay expired
+bool LogicChannel::checkDelayExpired(uint8_t iDelay)
+{
+    bool lResult = pExpiredDelays() & (1 << iDelay);
+    pExpiredDelays() &= ~(1 << iDelay);
+    return lResult;
+}
+
+// called from timing wheel, expiry is just relevant if according pipeline step still waits for it
+void LogicChannel::processDelayExpired(uint8_t iDelay)
+{
+    if (pCurrentPipeline() & cDelayPipeline[iDelay])
+    {
+        pExpiredDelays() |= (1 << iDelay);
+        sLogic->enqueueChannel(mChannelId);
+    }
+}
+
 bool LogicChannel::isInputActive(uint8_t iIOIndex)
 {
     uint8_t lIsActive = getByteParam((iIOIndex == IO_Input1) ? LOG_fE1 : LOG_fE2) & BIT_INPUT_MASK;
@@ -595,8 +779,8 @@ bool LogicChannel::isInputActive(uint8_t iIOIndex)
 // channel startup delay
 void LogicChannel::startStartup()
 {
-    pOnDelay = millis();
-    pCurrentPipeline |= PIP_STARTUP;
+    startDelay(DLY_STARTUP, getIntParam(LOG_fChannelDelay) * 1000);
+    startPipeline(PIP_STARTUP);
 #if LOGIC_TRACE
     if (debugFilter()) 
     {
@@ -607,18 +791,17 @@ void LogicChannel::startStartup()
 
 void LogicChannel::processStartup()
 {
-    if (delayCheck(pOnDelay, getIntParam(LOG_fChannelDelay) * 1000))
+    if (checkDelayExpired(DLY_STARTUP))
     {
         // we waited enough, remove pipeline marker
 #if LOGIC_TRACE
         if (debugFilter())
         {
-            channelDebug("endedStartup: waited %i ms\n", millis() - pOnDelay);
+            channelDebug("endedStartup: waited %i ms\n", getIntParam(LOG_fChannelDelay) * 1000);
         }
 #endif
-        pCurrentPipeline &= ~PIP_STARTUP;
-        pCurrentPipeline |= PIP_RUNNING;
-        pOnDelay = 0;
+        pCurrentPipeline() &= ~PIP_STARTUP;
+        pCurrentPipeline() |= PIP_RUNNING;
     }
 }
 
@@ -626,15 +809,13 @@ void LogicChannel::processInput(uint8_t iIOIndex)
 {
     if (iIOIndex == 0 || iIOIndex == 3)
         return;
-    uint16_t lParamBase = (iIOIndex == 1) ? LOG_fE1 : LOG_fE2;
     // we have now an event for an input, first we check, if this input is active
-    uint8_t lActive = getByteParam(lParamBase) & BIT_INPUT_MASK;
+    uint8_t lActive = getParams().input[iIOIndex - 1] & BIT_INPUT_MASK;
     if (lActive > 0)
         // this input is we start convert for this input
         startConvert(iIOIndex);
     // this input might also be used for delta conversion in the other input
-    uint16_t lOtherParamBase = (iIOIndex == 2) ? LOG_fE1 : LOG_fE2;
-    uint8_t lConverter = getByteParam(lOtherParamBase) >> LOG_fE1ConvertShift;
+    uint8_t lConverter = getParams().input[2 - iIOIndex] >> LOG_fE1ConvertShift;
     if (lConverter & 1)
     {
         // delta convertersion, we start convert for the other input
@@ -645,28 +826,30 @@ void LogicChannel::processInput(uint8_t iIOIndex)
 // we send an ReadRequest if reading from input 1 should be repeated
 void LogicChannel::processRepeatInput1()
 {
-    uint32_t lRepeatTime = getIntParam(LOG_fE1Repeat) * 1000;
+    uint32_t lRepeatTime = getParams().inputRepeat[0];
 
-    if (delayCheck(pInputProcessing.repeatInput1Delay, lRepeatTime))
+    if (checkDelayExpired(DLY_REPEAT_INPUT1))
     {
         knxRead(IO_Input1);
-        pInputProcessing.repeatInput1Delay = millis();
         if (lRepeatTime == 0)
-            pCurrentPipeline &= ~PIP_REPEAT_INPUT1;
+            pCurrentPipeline() &= ~PIP_REPEAT_INPUT1;
+        else
+            startDelay(DLY_REPEAT_INPUT1, lRepeatTime);
     }
 }
 
 // we send an ReadRequest if reading from input 1 should be repeated
 void LogicChannel::processRepeatInput2()
 {
-    uint32_t lRepeatTime = getIntParam(LOG_fE2Repeat) * 1000;
+    uint32_t lRepeatTime = getParams().inputRepeat[1];
 
-    if (delayCheck(pInputProcessing.repeatInput2Delay, lRepeatTime))
+    if (checkDelayExpired(DLY_REPEAT_INPUT2))
     {
         knxRead(IO_Input2);
-        pInputProcessing.repeatInput2Delay = millis();
         if (lRepeatTime == 0)
-            pCurrentPipeline &= ~PIP_REPEAT_INPUT2;
+            pCurrentPipeline() &= ~PIP_REPEAT_INPUT2;
+        else
+            startDelay(DLY_REPEAT_INPUT2, lRepeatTime);
     }
 }
 
@@ -678,6 +861,7 @@ void LogicChannel::stopRepeatInput(uint8_t iIOIndex)
     //    nevertheless the telegram was received (i.E. through an other read of a running channel)
     // 3. There is a continious read with condition "until telegram received"
     uint16_t lRepeatInputBit;
+    uint8_t lRepeatDelay;
     uint32_t lRepeatTime;
     bool lJustOneTelegram;
 
@@ -685,73 +869,67 @@ void LogicChannel::stopRepeatInput(uint8_t iIOIndex)
     {
         case 1:
             lRepeatInputBit = PIP_REPEAT_INPUT1;
-            lRepeatTime = getIntParam(LOG_fE1Repeat);
-            lJustOneTelegram = getByteParam(LOG_fE1DefaultRepeat) & LOG_fE1DefaultRepeatMask;
+            lRepeatDelay = DLY_REPEAT_INPUT1;
+            lRepeatTime = getParams().inputRepeat[0];
+            lJustOneTelegram = getParams().inputDefault[0] & LOG_fE1DefaultRepeatMask;
             break;
         case 2:
             lRepeatInputBit = PIP_REPEAT_INPUT2;
-            lRepeatTime = getIntParam(LOG_fE2Repeat);
-            lJustOneTelegram = getByteParam(LOG_fE2DefaultRepeat) & LOG_fE2DefaultRepeatMask;
+            lRepeatDelay = DLY_REPEAT_INPUT2;
+            lRepeatTime = getParams().inputRepeat[1];
+            lJustOneTelegram = getParams().inputDefault[1] & LOG_fE2DefaultRepeatMask;
             break;
         default:
             return;
             break;
     }
-    // if (!lJustOneTelegram || (pCurrentPipeline & PIP_RUNNING))
+    // if (!lJustOneTelegram || (pCurrentPipeline() & PIP_RUNNING))
     //     return;
-    if (pCurrentPipeline & lRepeatInputBit)
+    if (pCurrentPipeline() & lRepeatInputBit)
     {
         if (lRepeatTime == 0 || lJustOneTelegram)
-            pCurrentPipeline &= ~lRepeatInputBit;
+        {
+            pCurrentPipeline() &= ~lRepeatInputBit;
+            stopDelay(lRepeatDelay);
+        }
     }
 }
 
 void LogicChannel::startConvert(uint8_t iIOIndex)
 {
     if (iIOIndex == 1 || iIOIndex == 2) {
-        pCurrentPipeline |= (iIOIndex == 1) ? PIP_CONVERT_INPUT1 : PIP_CONVERT_INPUT2;
+        startPipeline((iIOIndex == 1) ? PIP_CONVERT_INPUT1 : PIP_CONVERT_INPUT2);
         stopRepeatInput(iIOIndex);
     }
 }
 
-bool LogicChannel::checkConvertValues(uint16_t iParamValues, uint8_t iDpt, int32_t iValue) {
+bool LogicChannel::checkConvertValues(uint8_t iIOIndex, int32_t iValue) {
+    uConvertParams &lParams = getParams().convert[iIOIndex - 1];
     bool lValueOut = false;
-    uint8_t lValueSize = 1;
-    uint8_t lNumValues = 1;
-    switch (iDpt)
+    switch (getParams().inputDpt[iIOIndex - 1])
     {
-        case VAL_DPT_2:
-            lNumValues = 4;
-            break;
         case VAL_DPT_5:
         case VAL_DPT_5001:
         case VAL_DPT_6:
-            lNumValues = 7;
+            for (uint8_t lIndex = 0; lIndex < 8 && !lValueOut; lIndex++)
+                lValueOut = ((uint8_t)iValue == lParams.byteValues[lIndex]);
             break;
         case VAL_DPT_7:
         case VAL_DPT_8:
-            lNumValues = 3;
-            lValueSize = 2;
-            break;
-        case VAL_DPT_17:
-            lNumValues = 8;
+            for (uint8_t lIndex = 0; lIndex < 4 && !lValueOut; lIndex++)
+                lValueOut = ((uint16_t)iValue == lParams.wordValues[lIndex]);
             break;
         default:
+            lValueOut = (iValue == lParams.bound.low);
             break;
     }
-    for (size_t lIndex = 0; lIndex < lNumValues && !lValueOut; lIndex++)
-    {
-        int32_t lValue = getParamByDpt(iDpt, iParamValues + lIndex * lValueSize);
-        lValueOut = (iValue == lValue);
-    }
     return lValueOut;
 }
 
 void LogicChannel::processConvertInput(uint8_t iIOIndex)
 {
-    uint16_t lParamBase = (iIOIndex == 1) ? LOG_fE1 : LOG_fE2;
-    uint16_t lParamLow = (iIOIndex == 1) ? LOG_fE1LowDelta : LOG_fE2LowDelta;
-    uint8_t lConvert = getByteParam(lParamBase) >> LOG_fE1ConvertShift;
+    uConvertParams &lParams = getParams().convert[iIOIndex - 1];
+    uint8_t lConvert = getParams().input[iIOIndex - 1] >> LOG_fE1ConvertShift;
     bool lValueOut = 0;
     // get input value
     int32_t lValue1In = getInputValue(iIOIndex);
@@ -761,8 +939,7 @@ void LogicChannel::processConvertInput(uint8_t iIOIndex)
         // in case of delta conversion get the other input value
         lValue2In = getInputValue(3 - iIOIndex);
     }
-    uint8_t lDpt = getByteParam(lParamBase + 1);
-    uint8_t lUpperBound = 0;
+    uint8_t lDpt = getParams().inputDpt[iIOIndex - 1];
     bool lDoDefault = false;
     switch (lDpt)
     {
@@ -776,19 +953,9 @@ void LogicChannel::processConvertInput(uint8_t iIOIndex)
 #endif
             break;
         case VAL_DPT_17:
-            // there might be 8 possible scenes to check
-            lUpperBound = 8; // we start with 2
-            lValue1In += 1;
         case VAL_DPT_2:
-            // there might be 4 possible "Zwangsführung" values to check
-            if (lUpperBound == 0)
-                lUpperBound = 4; // we start with 2
             // scenes or zwngsführung have no intervals, but multiple single values
-            for (size_t lScene = 0; lScene < lUpperBound && lValueOut == 0; lScene++)
-            {
-                uint8_t lValue = getByteParam(lParamLow + lScene);
-                lValueOut = ((uint8_t)lValue1In == lValue);
-            }
+            lValueOut = ((uint32_t)lValue1In < 64) && ((lParams.valueMask >> lValue1In) & 1);
             break;
 #if LOGIC_TRACE
             if (debugFilter())
@@ -813,8 +980,7 @@ void LogicChannel::processConvertInput(uint8_t iIOIndex)
         switch (lConvert)
         {
             case VAL_InputConvert_Interval:
-                lValueOut = (lValue1In >= getParamByDpt(lDpt, lParamLow + 0)) &&
-                            (lValue1In <= getParamByDpt(lDpt, lParamLow + 4));
+                lValueOut = (lValue1In >= lParams.bound.low) && (lValue1In <= lParams.bound.high);
 #if LOGIC_TRACE
                 if (debugFilter())
                 {
@@ -823,8 +989,7 @@ void LogicChannel::processConvertInput(uint8_t iIOIndex)
 #endif
                 break;
             case VAL_InputConvert_DeltaInterval:
-                lValueOut = (lValue1In - lValue2In >= getParamForDelta(lDpt, lParamLow + 0)) &&
-                            (lValue1In - lValue2In <= getParamForDelta(lDpt, lParamLow + 4));
+                lValueOut = (lValue1In - lValue2In >= lParams.bound.low) && (lValue1In - lValue2In <= lParams.bound.high);
 #if LOGIC_TRACE
                 if (debugFilter())
                 {
@@ -833,10 +998,10 @@ void LogicChannel::processConvertInput(uint8_t iIOIndex)
 #endif
                 break;
             case VAL_InputConvert_Hysterese:
-                lValueOut = pCurrentIn & iIOIndex; // retrieve old result, will be send if current value is in hysterese inbervall
-                if (lValue1In <= getParamByDpt(lDpt, lParamLow + 0))
+                lValueOut = pCurrentIn() & iIOIndex; // retrieve old result, will be send if current value is in hysterese inbervall
+                if (lValue1In <= lParams.bound.low)
                     lValueOut = false;
-                if (lValue1In >= getParamByDpt(lDpt, lParamLow + 4))
+                if (lValue1In >= lParams.bound.high)
                     lValueOut = true;
 #if LOGIC_TRACE
                 if (debugFilter())
@@ -846,10 +1011,10 @@ void LogicChannel::processConvertInput(uint8_t iIOIndex)
 #endif
                 break;
             case VAL_InputConvert_DeltaHysterese:
-                lValueOut = pCurrentIn & iIOIndex; // retrieve old result, will be send if current value is in hysterese inbervall
-                if (lValue1In - lValue2In <= getParamForDelta(lDpt, lParamLow + 0))
+                lValueOut = pCurrentIn() & iIOIndex; // retrieve old result, will be send if current value is in hysterese inbervall
+                if (lValue1In - lValue2In <= lParams.bound.low)
                     lValueOut = false;
-                if (lValue1In - lValue2In >= getParamForDelta(lDpt, lParamLow + 4))
+                if (lValue1In - lValue2In >= lParams.bound.high)
                     lValueOut = true;
 #if LOGIC_TRACE
                 if (debugFilter())
@@ -859,7 +1024,7 @@ void LogicChannel::processConvertInput(uint8_t iIOIndex)
 #endif
                 break;
             case VAL_InputConvert_Values:
-                lValueOut = checkConvertValues(lParamLow, lDpt, lValue1In);
+                lValueOut = checkConvertValues(iIOIndex, lValue1In);
 #if LOGIC_TRACE
                 if (debugFilter())
                 {
@@ -888,30 +1053,42 @@ void LogicChannel::processConvertInput(uint8_t iIOIndex)
         }
     }
     // remove processing flag from pipeline
-    pCurrentPipeline &= (iIOIndex == IO_Input1) ? ~PIP_CONVERT_INPUT1 : ~PIP_CONVERT_INPUT2;
+    pCurrentPipeline() &= (iIOIndex == IO_Input1) ? ~PIP_CONVERT_INPUT1 : ~PIP_CONVERT_INPUT2;
     // start logic processing for this input
     startLogic(iIOIndex, lValueOut);
 }
 
+void LogicChannel::processConvertInput1()
+{
+    processConvertInput(IO_Input1);
+}
+
+void LogicChannel::processConvertInput2()
+{
+    processConvertInput(IO_Input2);
+}
+
 void LogicChannel::startLogic(uint8_t iIOIndex, bool iValue)
 {
     // invert input
     bool lValue = iValue;
-    uint16_t lParamBase = (iIOIndex == BIT_EXT_INPUT_1) ? LOG_fE1 : (iIOIndex == BIT_EXT_INPUT_2) ? LOG_fE2 : (iIOIndex == BIT_INT_INPUT_1) ? LOG_fI1 : LOG_fI2;
-    uint8_t lInput = getByteParam(lParamBase);
+    uint8_t lInput = (iIOIndex == BIT_EXT_INPUT_1) ? getParams().input[0] : (iIOIndex == BIT_EXT_INPUT_2) ? getParams().input[1] : getParams().internalInput;
     if (iIOIndex == BIT_INT_INPUT_1)
         lInput >>= 4;
     if ((lInput & BIT_INPUT_MASK) == 2)
         lValue = !iValue;
     // set according input bit
-    pCurrentIn &= ~iIOIndex;
-    pCurrentIn |= iIOIndex * lValue;
+    pCurrentIn() &= ~iIOIndex;
+    pCurrentIn() |= iIOIndex * lValue;
     // set the validity bit
-    pValidActiveIO |= iIOIndex;
+    pValidActiveIO() |= iIOIndex;
     // set the trigger bit
-    pTriggerIO |= iIOIndex;
-    // finally set the pipeline bit
-    pCurrentPipeline |= PIP_LOGIC_EXECUTE;
+    pTriggerIO() |= iIOIndex;
+    // finally set the pipeline bit, simple logics are evaluated in batch
+    if (isBatchLogic())
+        sLogic->updateLogicBatch(mChannelId, pCurrentIn(), pValidActiveIO());
+    else
+        startPipeline(PIP_LOGIC_EXECUTE);
 #if LOGIC_TRACE  
     if (debugFilter())
     {
@@ -920,155 +1097,161 @@ void LogicChannel::startLogic(uint8_t iIOIndex, bool iValue)
 #endif
 }
 
+/********************************
+ * Logic kernels, one of them is bound to the channel
+ * according to its logical function
+ *******************************/
+#if LOGIC_TRACE
+const char *LogicChannel::cLogicNames[VAL_Logic_Timer + 1] = {"Invalid Logic", "AND", "OR", "EXOR", "TOR", "TIMER"};
+#endif
+
+// AND, OR and EXOR are never executed in pipeline, Logic::processLogicBatch() evaluates them
+const LogicChannel::LogicKernel LogicChannel::cLogicKernels[VAL_Logic_Timer + 1] = {
+    &LogicChannel::logicInvalid,
+    &LogicChannel::logicInvalid,
+    &LogicChannel::logicInvalid,
+    &LogicChannel::logicInvalid,
+    &LogicChannel::logicGate,
+    &LogicChannel::logicTimer};
+
+void LogicChannel::bindLogicKernel()
+{
+    uint8_t lLogic = mParams.logic;
+    if (lLogic > VAL_Logic_Timer)
+        lLogic = 0;
+    mLogicKernel = cLogicKernels[lLogic];
+}
+
+bool LogicChannel::logicInvalid(uint8_t iValidInputs, uint8_t iActiveInputs, uint8_t iCurrentInputs, bool &cValidOutput)
+{
+    cValidOutput = false;
+    return false;
+}
+
+// GATE works a little bit more complex
+// E1 OR I1 are the data inputs
+// E2 OR I2 are the gate inputs
+// Invalid data is handled as ???
+bool LogicChannel::logicGate(uint8_t iValidInputs, uint8_t iActiveInputs, uint8_t iCurrentInputs, bool &cValidOutput)
+{
+    bool lNewOutput = false;
+    // Invalid gate is a closed gate (0), as described in app doc
+    // if the behaviour should be changed (invalid is open), 
+    // just change the init (for gate and previous) to true.
+    bool lGate = false;
+    bool lPreviousGate = false;
+    // check if gate input is valid
+    if (iValidInputs & (BIT_EXT_INPUT_2 | BIT_INT_INPUT_2)) {
+        // get the current gate state
+        lGate = (iCurrentInputs & (BIT_EXT_INPUT_2 | BIT_INT_INPUT_2));
+        // get the previous gate state
+        lPreviousGate = pCurrentIn() & BIT_PREVIOUS_GATE;
+        // set previous gate state for next roundtrip
+        pCurrentIn() &= ~BIT_PREVIOUS_GATE;
+        if (lGate)
+            pCurrentIn() |= BIT_PREVIOUS_GATE;
+    }
+    uint8_t lGateState = 2 * lPreviousGate + lGate;
+    uint8_t lGateTrigger = 0xFF;
+    cValidOutput = false;
+    switch (lGateState)
+    {
+        case VAL_Gate_Closed_Open: // was closed and opens now
+            lGateTrigger = mParams.gateTriggerOpen;
+        case VAL_Gate_Open_Close: // was open and closes now
+            {
+                if (lGateTrigger == 0xFF)
+                    lGateTrigger = mParams.gateTriggerClose;
+                uint8_t lOnGateTrigger = lGateTrigger & 3;
+                cValidOutput = true;
+                switch (lOnGateTrigger)
+                {
+                    case VAL_Gate_Send_Off:
+                        lNewOutput = false;
+                        break;
+                    case VAL_Gate_Send_On:
+                        lNewOutput = true;
+                        break;
+                    case VAL_Gate_Send_Input:
+                        lNewOutput = (iCurrentInputs & (BIT_EXT_INPUT_1 | BIT_INT_INPUT_1));
+                        break;
+                    default: // same as VAL_Gate_Send_Nothing
+                        cValidOutput = false;
+                        break;
+                }
+            }
+            break;
+        case VAL_Gate_Open_Open: // was open and stays open
+            lNewOutput = (iCurrentInputs & (BIT_EXT_INPUT_1 | BIT_INT_INPUT_1));
+            cValidOutput = true;
+            break;
+        default: // same as VAL_Gate_Closed_Close
+            break;
+    }
+    return lNewOutput;
+}
+
+bool LogicChannel::logicTimer(uint8_t iValidInputs, uint8_t iActiveInputs, uint8_t iCurrentInputs, bool &cValidOutput)
+{
+    cValidOutput = true;
+    return (iCurrentInputs & BIT_EXT_INPUT_2);
+}
+
 // Processing parametrized logic
 void LogicChannel::processLogic()
 {
     /* Logic execution bit is set from any method which changes input values */
-    uint8_t lValidInputs = pValidActiveIO & BIT_INPUT_MASK;
-    uint8_t lActiveInputs = (pValidActiveIO >> 4) & BIT_INPUT_MASK;
-    uint8_t lCurrentInputs = pCurrentIn & lValidInputs;
-    bool lCurrentOuput = (pCurrentOut & BIT_OUTPUT_LOGIC);
+    uint8_t lValidInputs = pValidActiveIO() & BIT_INPUT_MASK;
+    uint8_t lActiveInputs = (pValidActiveIO() >> 4) & BIT_INPUT_MASK;
+    uint8_t lCurrentInputs = pCurrentIn() & lValidInputs;
     bool lNewOutput = false;
     bool lValidOutput = false;
-#if LOGIC_TRACE
-    bool lDebugValid = false;
-    char *lDebugLogic = "Invalid input";
-#endif
+    bool lEvaluated = false;
     // first deactivate execution in pipeline
-    pCurrentPipeline &= ~PIP_LOGIC_EXECUTE;
-    // we have to delete all trigger if output pipeline is not started
-    if ((getByteParam(LOG_fCalculate) & LOG_fCalculateMask) == 0 || lValidInputs == lActiveInputs)
+    pCurrentPipeline() &= ~PIP_LOGIC_EXECUTE;
+    if ((getParams().calculate & LOG_fCalculateMask) == 0 || lValidInputs == lActiveInputs)
     {
         // we process only if all inputs are valid or the user requested invalid evaluation
-        uint8_t lLogic = (getByteParam(LOG_fDisable) & LOG_fDisableMask) ? 0 : getByteParam(LOG_fLogic);
-        uint8_t lOnes = 0;
-        switch (lLogic)
-        {
-            case VAL_Logic_And:
-                // AND handles invalid inputs as 1
-                //Check if all bits are set -> logical AND of all input bits
-                lNewOutput = (lCurrentInputs == lActiveInputs);
-                lValidOutput = true;
-#if LOGIC_TRACE
-                lDebugLogic = "AND";
-#endif
-                break;
-            case VAL_Logic_Or:
-                // Check if any bit is set -> logical OR of all input bits
-                lNewOutput = (lCurrentInputs > 0);
-                lValidOutput = true;
-#if LOGIC_TRACE
-                lDebugLogic = "OR";
-#endif
-                break;
-            case VAL_Logic_ExOr:
-                // EXOR handles invalid inputs as non existig
-                // count valid bits in input mask
-                for (size_t lBit = 1; lBit < BIT_INPUT_MASK; lBit <<= 1)
-                    lOnes += (lCurrentInputs & lBit) > 0;
-                // Check if we have an odd number of bits -> logical EXOR of all input bits
-                lNewOutput = (lOnes % 2 == 1);
-                lValidOutput = true;
-#if LOGIC_TRACE
-                lDebugLogic = "EXOR";
-#endif
-                break;
-            case VAL_Logic_Gate:
-                // GATE works a little bit more complex
-                // E1 OR I1 are the data inputs
-                // E2 OR I2 are the gate inputs
-                // Invalid data is handled as ???
-                {
-                    // Invalid gate is a closed gate (0), as described in app doc
-                    // if the behaviour should be changed (invalid is open), 
-                    // just change the init (for gate and previous) to true.
-                    bool lGate = false;
-                    bool lPreviousGate = false;
-                    // check if gate input is valid
-                    if (lValidInputs & (BIT_EXT_INPUT_2 | BIT_INT_INPUT_2)) {
-                        // get the current gate state
-                        lGate = (lCurrentInputs & (BIT_EXT_INPUT_2 | BIT_INT_INPUT_2));
-                        // get the previous gate state
-                        lPreviousGate = pCurrentIn & BIT_PREVIOUS_GATE;
-                        // set previous gate state for next roundtrip
-                        pCurrentIn &= ~BIT_PREVIOUS_GATE;
-                        if (lGate)
-                            pCurrentIn |= BIT_PREVIOUS_GATE;
-                    }
-                    uint8_t lGateState = 2 * lPreviousGate + lGate;
-                    uint8_t lGateTrigger = 0;
-                    switch (lGateState)
-                    {
-                        case VAL_Gate_Closed_Open: // was closed and opens now
-                            lGateTrigger = LOG_fTriggerGateOpen;
-                        case VAL_Gate_Open_Close: // was open and closes now
-                            {
-                                if (lGateTrigger == 0)
-                                    lGateTrigger = LOG_fTriggerGateClose;
-                                uint8_t lOnGateTrigger = getByteParam(lGateTrigger) & 3;
-                                lValidOutput = true;
-                                switch (lOnGateTrigger)
-                                {
-                                    case VAL_Gate_Send_Off:
-                                        lNewOutput = false;
-                                        break;
-                                    case VAL_Gate_Send_On:
-                                        lNewOutput = true;
-                                        break;
-                                    case VAL_Gate_Send_Input:
-                                        lNewOutput = (lCurrentInputs & (BIT_EXT_INPUT_1 | BIT_INT_INPUT_1));
-                                        break;
-                                    default: // same as VAL_Gate_Send_Nothing
-                                        lValidOutput = false;
-                                        break;
-                                }
-                            }
-                            break;
-                        case VAL_Gate_Open_Open: // was open and stays open
-                            lNewOutput = (lCurrentInputs & (BIT_EXT_INPUT_1 | BIT_INT_INPUT_1));
-                            lValidOutput = true;
-                            break;
-                        default: // same as VAL_Gate_Closed_Close
-                            lValidOutput = false;
-                            break;
-                    }
-#if LOGIC_TRACE
-                    lDebugLogic = "TOR";
-#endif
-                }
-                break;
-            case VAL_Logic_Timer:
-                lNewOutput = (lCurrentInputs & BIT_EXT_INPUT_2);
-                lValidOutput = true;
+        lNewOutput = (this->*mLogicKernel)(lValidInputs, lActiveInputs, lCurrentInputs, lValidOutput);
+        lEvaluated = true;
+    }
+    finishLogic(lEvaluated, lValidOutput, lNewOutput);
+}
+
+// processes the result of a logic evaluation, also called from batch evaluation
+void LogicChannel::finishLogic(bool iEvaluated, bool iValidOutput, bool iNewOutput)
+{
+    bool lNewOutput = iNewOutput;
+    bool lCurrentOuput = (pCurrentOut() & BIT_OUTPUT_LOGIC);
+    sChannelParams &lParams = getParams();
 #if LOGIC_TRACE
-                lDebugLogic = "TIMER";
+    bool lDebugValid = false;
+    const char *lDebugLogic = "Invalid input";
 #endif
-                break;
-            default:
+    // we have to delete all trigger if output pipeline is not started
+    if (iEvaluated)
+    {
 #if LOGIC_TRACE
-                lDebugLogic = "Invalid Logic";
+        lDebugLogic = cLogicNames[(lParams.logic > VAL_Logic_Timer) ? 0 : lParams.logic];
 #endif
-                break;
-        }
         // now there is a new Output value and we know, if it is valid
         // lets check, if we send this value through the pipeline
         // and if not, we have to delete all trigger
-        if (lValidOutput)
+        if (iValidOutput)
         {
-            uint8_t lTrigger = getByteParam(LOG_fTrigger);
-            uint8_t lHandleFirstProcessing = (lTrigger & 0x30);
-            lTrigger &= BIT_INPUT_MASK;
+            uint8_t lTrigger = lParams.triggerInputs;
+            uint8_t lHandleFirstProcessing = lParams.triggerFirstProcessing;
             if (lHandleFirstProcessing == 0)
-                pCurrentIn |= BIT_FIRST_PROCESSING;
+                pCurrentIn() |= BIT_FIRST_PROCESSING;
             if ((lTrigger == 0 && lNewOutput != lCurrentOuput) ||                         /* Just Changes  */
-                (lTrigger & pTriggerIO) > 0 ||                                            /* each telegram on specific input */
-                (lHandleFirstProcessing > 0 && (pCurrentIn & BIT_FIRST_PROCESSING) == 0)) /* first processing */
+                (lTrigger & pTriggerIO()) > 0 ||                                            /* each telegram on specific input */
+                (lHandleFirstProcessing > 0 && (pCurrentIn() & BIT_FIRST_PROCESSING) == 0)) /* first processing */
             {
                 // set the output value (first delete BIT_OUTPUT and then set the value
                 // of lNewOutput)
-                pCurrentOut = (pCurrentOut & ~BIT_OUTPUT_LOGIC) | (lNewOutput * BIT_OUTPUT_LOGIC);
+                pCurrentOut() = (pCurrentOut() & ~BIT_OUTPUT_LOGIC) | (lNewOutput * BIT_OUTPUT_LOGIC);
                 // in case that first processing should be skipped, this happens here
-                if (pCurrentIn & BIT_FIRST_PROCESSING || lHandleFirstProcessing == BIT_FIRST_PROCESSING)
+                if (pCurrentIn() & BIT_FIRST_PROCESSING || lHandleFirstProcessing == BIT_FIRST_PROCESSING)
                 {
 #if LOGIC_TRACE
                     lDebugValid = true;
@@ -1080,7 +1263,7 @@ void LogicChannel::processLogic()
                     // now we start stairlight processing
                     startStairlight(lNewOutput);
                 }
-                pCurrentIn |= BIT_FIRST_PROCESSING; //first processing was done
+                pCurrentIn() |= BIT_FIRST_PROCESSING; //first processing was done
             }
 #if LOGIC_TRACE
             else
@@ -1091,10 +1274,10 @@ void LogicChannel::processLogic()
                     if (lTrigger == 0 && lNewOutput == lCurrentOuput) { 
                         channelDebug("endedLogic: No execution, Logic %s, Value %i (Value not changed)\n", lDebugLogic, lNewOutput);
                     }
-                    else if ((lTrigger & pTriggerIO) == 0) {
+                    else if ((lTrigger & pTriggerIO()) == 0) {
                         channelDebug("endedLogic: No execution, Logic %s, Value %i (Input was not a trigger)\n", lDebugLogic, lNewOutput);
                     }
-                    else if (lHandleFirstProcessing > 0 && (pCurrentIn & BIT_FIRST_PROCESSING) > 0) {
+                    else if (lHandleFirstProcessing > 0 && (pCurrentIn() & BIT_FIRST_PROCESSING) > 0) {
                         channelDebug("endedLogic: No execution, Logic %s, Value %i (Skipped first processing)\n", lDebugLogic, lNewOutput);
                     }
                 }
@@ -1107,14 +1290,14 @@ void LogicChannel::processLogic()
         channelDebug("endedLogic: No execution, Logic %s\n", lDebugLogic);
     }
 #endif
-    pCurrentIODebug = (pCurrentIn & BIT_INPUT_MASK) | ((pCurrentOut & BIT_OUTPUT_LOGIC) ? BIT_OUTPUT_DEBUG : 0);
+    pCurrentIODebug() = (pCurrentIn() & BIT_INPUT_MASK) | ((pCurrentOut() & BIT_OUTPUT_LOGIC) ? BIT_OUTPUT_DEBUG : 0);
     // reset trigger as soon as this logic is executed
-    pTriggerIO = 0;
+    pTriggerIO() = 0;
 }
 
 void LogicChannel::startStairlight(bool iOutput)
 {
-    if (getByteParam(LOG_fOStair) & LOG_fOStairMask)
+    if (getParams().stairlight & LOG_fOStairMask)
     {
 #if LOGIC_TRACE
         uint8_t lStairTimeBase = getByteParam(LOG_fOTimeBase);
@@ -1123,11 +1306,11 @@ void LogicChannel::startStairlight(bool iOutput)
         if (iOutput)
         {
             // if stairlight is not running yet, we switch first the output to on
-            if ((pCurrentPipeline & PIP_STAIRLIGHT) == 0)
+            if ((pCurrentPipeline() & PIP_STAIRLIGHT) == 0)
                 startOnDelay();
             // stairlight should also be switched on
-            bool lRetrigger = getByteParam(LOG_fORetrigger) & LOG_fORetriggerMask;
-            if ((pCurrentPipeline & PIP_STAIRLIGHT) == 0 || lRetrigger)
+            bool lRetrigger = getParams().stairlight & LOG_fORetriggerMask;
+            if ((pCurrentPipeline() & PIP_STAIRLIGHT) == 0 || lRetrigger)
             {
                 // stairlight is not running or may be retriggered
                 // we init the stairlight timer
@@ -1141,23 +1324,23 @@ void LogicChannel::startStairlight(bool iOutput)
                     }
                 }
 #endif
-                pStairlightDelay = millis();
-                pCurrentPipeline |= PIP_STAIRLIGHT;
+                startDelay(DLY_STAIRLIGHT, getParams().stairlightTime);
+                startPipeline(PIP_STAIRLIGHT);
                 startBlink();
             }
         }
         else
         {
             // if stairlight is not running yet, we switch the output to off
-            if ((pCurrentPipeline & PIP_STAIRLIGHT) == 0)
+            if ((pCurrentPipeline() & PIP_STAIRLIGHT) == 0)
                 startOffDelay();
             // stairlight should be switched off
-            bool lOff = getByteParam(LOG_fOStairOff) & LOG_fOStairOffMask;
+            bool lOff = getParams().stairlight & LOG_fOStairOffMask;
             if (lOff)
             {
                 // stairlight might be switched off,
                 // we set the timer to 0
-                pStairlightDelay = 0;
+                startDelay(DLY_STAIRLIGHT, 0);
 #if LOGIC_TRACE
                 if (debugFilter()) 
                 {
@@ -1180,23 +1363,22 @@ void LogicChannel::startStairlight(bool iOutput)
 
 void LogicChannel::processStairlight()
 {
-    uint8_t lStairTimeBase = getByteParam(LOG_fOTimeBase);
-    uint32_t lStairTime = getIntParam(LOG_fOTime);
-    uint32_t lTime = lStairTime * cTimeFactors[lStairTimeBase];
-
-    if (delayCheck(pStairlightDelay, lTime))
+    if (checkDelayExpired(DLY_STAIRLIGHT))
     {
 #if LOGIC_TRACE
+        uint8_t lStairTimeBase = getByteParam(LOG_fOTimeBase);
+        uint32_t lStairTime = getIntParam(LOG_fOTime);
         if (debugFilter()) 
         {
-            if (pCurrentPipeline & PIP_BLINK) {
+            if (pCurrentPipeline() & PIP_BLINK) {
                 channelDebug("endedBlink");
             }
             channelDebug("endedStairlight: Factor %i, Base %s\n", lStairTime, (lStairTimeBase == 0) ? "sec/10" : (lStairTimeBase == 1) ? "sec" : (lStairTimeBase == 2) ? "min" : "h");
         }
 #endif
         // stairlight time is over, we switch off, also potential blinking
-        pCurrentPipeline &= ~(PIP_STAIRLIGHT | PIP_BLINK);
+        pCurrentPipeline() &= ~(PIP_STAIRLIGHT | PIP_BLINK);
+        stopDelay(DLY_BLINK);
         // we start switchOffProcessing
         startOffDelay();
     }
@@ -1204,27 +1386,26 @@ void LogicChannel::processStairlight()
 
 void LogicChannel::startBlink()
 {
-    uint32_t lBlinkTime = getIntParam(LOG_fOBlink);
+    uint32_t lBlinkTime = getParams().blinkTime;
     if (lBlinkTime > 0)
     {
 #if LOGIC_TRACE
         if (debugFilter())
         {
-            channelDebug("startBlink: BlinkTime %8.1f s\n", lBlinkTime / 10.0);
+            channelDebug("startBlink: BlinkTime %8.1f s\n", lBlinkTime / 1000.0);
         }
 #endif
-        pBlinkDelay = millis();
-        pCurrentPipeline |= PIP_BLINK;
-        pCurrentOut |= BIT_OUTPUT_BLINK;
+        startDelay(DLY_BLINK, lBlinkTime);
+        startPipeline(PIP_BLINK);
+        pCurrentOut() |= BIT_OUTPUT_BLINK;
     }
 }
 
 void LogicChannel::processBlink()
 {
-    uint32_t lBlinkTime = getIntParam(LOG_fOBlink) * 100;
-    if (delayCheck(pBlinkDelay, lBlinkTime))
+    if (checkDelayExpired(DLY_BLINK))
     {
-        bool lOn = (pCurrentOut & BIT_OUTPUT_BLINK);
+        bool lOn = (pCurrentOut() & BIT_OUTPUT_BLINK);
         if (!lOn)
         {
 #if LOGIC_TRACE
@@ -1233,7 +1414,7 @@ void LogicChannel::processBlink()
                 channelDebug("processBlink: On\n");
             }
 #endif
-            pCurrentOut |= BIT_OUTPUT_BLINK;
+            pCurrentOut() |= BIT_OUTPUT_BLINK;
             startOnDelay();
         }
         else
@@ -1244,10 +1425,10 @@ void LogicChannel::processBlink()
                 channelDebug("processBlink: Off\n");
             }
 #endif
-            pCurrentOut &= ~BIT_OUTPUT_BLINK;
+            pCurrentOut() &= ~BIT_OUTPUT_BLINK;
             startOffDelay();
         }
-        pBlinkDelay = millis();
+        startDelay(DLY_BLINK, getParams().blinkTime);
     }
 }
 
@@ -1259,17 +1440,17 @@ void LogicChannel::startOnDelay()
     //    2. second on restarts delay time
     //    3. second on switches immediately on
     //    4. an off stops on delay
-    uint8_t lOnDelay = getByteParam(LOG_fODelay);
+    uint8_t lOnDelay = getParams().delay;
     uint8_t lOnDelayRepeat = (lOnDelay & LOG_fODelayOnRepeatMask) >> LOG_fODelayOnRepeatShift;
-    if ((pCurrentPipeline & PIP_ON_DELAY) == 0)
+    if ((pCurrentPipeline() & PIP_ON_DELAY) == 0)
     {
         // on delay is not running, we start it 
-        pOnDelay = millis();
-        pCurrentPipeline |= PIP_ON_DELAY;
+        startDelay(DLY_ON_DELAY, getParams().onDelay);
+        startPipeline(PIP_ON_DELAY);
 #if LOGIC_TRACE
         if (debugFilter())
         {
-            channelDebug("startOnDelay: Time %0.1f s\n", getIntParam(LOG_fODelayOn) / 10.0);
+            channelDebug("startOnDelay: Time %0.1f s\n", getParams().onDelay / 1000.0);
         }
 #endif
     }
@@ -1282,7 +1463,7 @@ void LogicChannel::startOnDelay()
                 // end pipeline and switch immediately
                 // cData->currentPipeline &= ~PIP_ON_DELAY;
                 // StartOnOffRepeat(cData, iChannel, true);
-                pOnDelay = 0;
+                startDelay(DLY_ON_DELAY, 0);
 #if LOGIC_TRACE
                 if (debugFilter())
                 {
@@ -1291,11 +1472,11 @@ void LogicChannel::startOnDelay()
 #endif
                 break;
             case VAL_Delay_Extend:
-                pOnDelay = millis();
+                startDelay(DLY_ON_DELAY, getParams().onDelay);
 #if LOGIC_TRACE
                 if (debugFilter())
                 {
-                    channelDebug("startOnDelay: Sencond ON, extend delay by %0.1f s\n", getIntParam(LOG_fODelayOn) / 10.0);
+                    channelDebug("startOnDelay: Sencond ON, extend delay by %0.1f s\n", getParams().onDelay / 1000.0);
                 }
 #endif
                 break;
@@ -1303,7 +1484,7 @@ void LogicChannel::startOnDelay()
 #if LOGIC_TRACE
                 if (debugFilter())
                 {
-                    channelDebug("startOnDelay: Sencond ON, simply continue, remaining %li\n", millis() - pOnDelay);
+                    channelDebug("startOnDelay: Sencond ON, simply continue, remaining %li\n", getDelayRemaining(DLY_ON_DELAY));
                 }
 #endif
                 break;
@@ -1311,7 +1492,7 @@ void LogicChannel::startOnDelay()
     }
     uint8_t lOffDelayReset = (lOnDelay & LOG_fODelayOffResetMask) >> LOG_fODelayOffResetShift;
     // if requested, this on stops an off delay
-    if ((lOffDelayReset > 0) && (pCurrentPipeline & PIP_OFF_DELAY) > 0)
+    if ((lOffDelayReset > 0) && (pCurrentPipeline() & PIP_OFF_DELAY) > 0)
     {
 #if LOGIC_TRACE
         if (debugFilter())
@@ -1319,27 +1500,26 @@ void LogicChannel::startOnDelay()
             channelDebug("endedOffDelay: ON during OffDelay\n");
         }
 #endif
-        pCurrentPipeline &= ~PIP_OFF_DELAY;
+        pCurrentPipeline() &= ~PIP_OFF_DELAY;
         // there might be an additional option necessary:
         // - an additional ON stops processing
         // currently we do this by default
-        // pCurrentPipeline &= ~PIP_ON_DELAY;
+        // pCurrentPipeline() &= ~PIP_ON_DELAY;
     }
 }
 
 void LogicChannel::processOnDelay()
 {
-    uint32_t lOnDelay = getIntParam(LOG_fODelayOn) * 100;
-    if (delayCheck(pOnDelay, lOnDelay))
+    if (checkDelayExpired(DLY_ON_DELAY))
     {
 #if LOGIC_TRACE
         if (debugFilter())
         {
-            channelDebug("endedOnDelay: Normal delay time %0.1f\n", getIntParam(LOG_fODelayOn) / 10.0);
+            channelDebug("endedOnDelay: Normal delay time %0.1f\n", getParams().onDelay / 1000.0);
         }
 #endif
         // delay time is over, we turn off pipeline
-        pCurrentPipeline &= ~PIP_ON_DELAY;
+        pCurrentPipeline() &= ~PIP_ON_DELAY;
         // we start repeatOnProcessing
         startOutputFilter(true);
     }
@@ -1352,16 +1532,16 @@ void LogicChannel::startOffDelay()
     //    1. second off switches immediately off
     //    2. second off restarts delay time
     //    3. an on stops off delay
-    uint8_t lOffDelay = getByteParam(LOG_fODelay);
+    uint8_t lOffDelay = getParams().delay;
     uint8_t lOffDelayRepeat = (lOffDelay & LOG_fODelayOffRepeatMask) >> LOG_fODelayOffRepeatShift;
-    if ((pCurrentPipeline & PIP_OFF_DELAY) == 0)
+    if ((pCurrentPipeline() & PIP_OFF_DELAY) == 0)
     {
-        pOffDelay = millis();
-        pCurrentPipeline |= PIP_OFF_DELAY;
+        startDelay(DLY_OFF_DELAY, getParams().offDelay);
+        startPipeline(PIP_OFF_DELAY);
 #if LOGIC_TRACE
         if (debugFilter())
         {
-            channelDebug("startOffDelay: Time %0.1f s\n", getIntParam(LOG_fODelayOff) / 10.0);
+            channelDebug("startOffDelay: Time %0.1f s\n", getParams().offDelay / 1000.0);
         }
 #endif
     }
@@ -1374,7 +1554,7 @@ void LogicChannel::startOffDelay()
                 // end pipeline and switch immediately
                 // cData->currentPipeline &= ~PIP_OFF_DELAY;
                 // StartOnOffRepeat(cData, iChannel, false);
-                pOffDelay = 0;
+                startDelay(DLY_OFF_DELAY, 0);
 #if LOGIC_TRACE
                 if (debugFilter())
                 {
@@ -1383,11 +1563,11 @@ void LogicChannel::startOffDelay()
 #endif
                 break;
             case VAL_Delay_Extend:
-                pOffDelay = millis();
+                startDelay(DLY_OFF_DELAY, getParams().offDelay);
 #if LOGIC_TRACE
                 if (debugFilter())
                 {
-                    channelDebug("startOffDelay: Sencond OFF, extend delay by %0.1f s\n", getIntParam(LOG_fODelayOff) / 10.0);
+                    channelDebug("startOffDelay: Sencond OFF, extend delay by %0.1f s\n", getParams().offDelay / 1000.0);
                 }
 #endif
                 break;
@@ -1395,7 +1575,7 @@ void LogicChannel::startOffDelay()
 #if LOGIC_TRACE
                 if (debugFilter())
                 {
-                    channelDebug("startOffDelay: Sencond OFF, simply continue, remaining %li\n", millis() - pOffDelay);
+                    channelDebug("startOffDelay: Sencond OFF, simply continue, remaining %li\n", getDelayRemaining(DLY_OFF_DELAY));
                 }
 #endif
                 break;
@@ -1403,7 +1583,7 @@ void LogicChannel::startOffDelay()
     }
     uint8_t lOnDelayReset = (lOffDelay & LOG_fODelayOnResetMask) >> LOG_fODelayOnResetShift;
     // if requested, this off stops an on delay
-    if ((lOnDelayReset > 0) && (pCurrentPipeline & PIP_ON_DELAY) > 0)
+    if ((lOnDelayReset > 0) && (pCurrentPipeline() & PIP_ON_DELAY) > 0)
     {
 #if LOGIC_TRACE
         if (debugFilter())
@@ -1411,27 +1591,26 @@ void LogicChannel::startOffDelay()
             channelDebug("endedOnDelay: OFF during OnDelay\n");
         }
 #endif
-        pCurrentPipeline &= ~PIP_ON_DELAY;
+        pCurrentPipeline() &= ~PIP_ON_DELAY;
         // there might be an additional option necessary:
         // - an additional OFF stops processing
         // currently we do this by default
-        // pCurrentPipeline &= ~PIP_OFF_DELAY;
+        // pCurrentPipeline() &= ~PIP_OFF_DELAY;
     }
 }
 
 void LogicChannel::processOffDelay()
 {
-    uint32_t lOffDelay = getIntParam(LOG_fODelayOff) * 100;
-    if (delayCheck(pOffDelay, lOffDelay))
+    if (checkDelayExpired(DLY_OFF_DELAY))
     {
 #if LOGIC_TRACE
         if (debugFilter())
         {
-            channelDebug("endedOffDelay: Normal delay time %0.1f\n", getIntParam(LOG_fODelayOff) / 10.0);
+            channelDebug("endedOffDelay: Normal delay time %0.1f\n", getParams().offDelay / 1000.0);
         }
 #endif
         // delay time is over, we turn off pipeline
-        pCurrentPipeline &= ~PIP_OFF_DELAY;
+        pCurrentPipeline() &= ~PIP_OFF_DELAY;
         // we start repeatOffProcessing
         startOutputFilter(false);
     }
@@ -1440,8 +1619,8 @@ void LogicChannel::processOffDelay()
 // Output filter prevents repetition of 0 or 1 values
 void LogicChannel::startOutputFilter(bool iOutput)
 {
-    uint8_t lAllow = (getByteParam(LOG_fOOutputFilter) & LOG_fOOutputFilterMask) >> LOG_fOOutputFilterShift;
-    bool lLastOutput = (pCurrentOut & BIT_OUTPUT_PREVIOUS) > 0;
+    uint8_t lAllow = (getParams().stairlight & LOG_fOOutputFilterMask) >> LOG_fOOutputFilterShift;
+    bool lLastOutput = (pCurrentOut() & BIT_OUTPUT_PREVIOUS) > 0;
     bool lContinue = false;
     switch (lAllow)
     {
@@ -1460,24 +1639,24 @@ void LogicChannel::startOutputFilter(bool iOutput)
     }
     if (lContinue)
     {
-        pCurrentPipeline &= ~(PIP_OUTPUT_FILTER_OFF | PIP_OUTPUT_FILTER_ON);
-        pCurrentPipeline |= iOutput ? PIP_OUTPUT_FILTER_ON : PIP_OUTPUT_FILTER_OFF;
-        pCurrentOut &= ~BIT_OUTPUT_PREVIOUS;
+        pCurrentPipeline() &= ~(PIP_OUTPUT_FILTER_OFF | PIP_OUTPUT_FILTER_ON);
+        startPipeline(iOutput ? PIP_OUTPUT_FILTER_ON : PIP_OUTPUT_FILTER_OFF);
+        pCurrentOut() &= ~BIT_OUTPUT_PREVIOUS;
         if (iOutput)
-            pCurrentOut |= BIT_OUTPUT_PREVIOUS;
+            pCurrentOut() |= BIT_OUTPUT_PREVIOUS;
     }
 }
 void LogicChannel::processOutputFilter()
 {
-    if (pCurrentPipeline & PIP_OUTPUT_FILTER_ON)
+    if (pCurrentPipeline() & PIP_OUTPUT_FILTER_ON)
     {
         startOnOffRepeat(true);
     }
-    else if (pCurrentPipeline & PIP_OUTPUT_FILTER_OFF)
+    else if (pCurrentPipeline() & PIP_OUTPUT_FILTER_OFF)
     {
         startOnOffRepeat(false);
     }
-    pCurrentPipeline &= ~(PIP_OUTPUT_FILTER_OFF | PIP_OUTPUT_FILTER_ON);
+    pCurrentPipeline() &= ~(PIP_OUTPUT_FILTER_OFF | PIP_OUTPUT_FILTER_ON);
 }
 
 // starts On-Off-Repeat
@@ -1487,17 +1666,17 @@ void LogicChannel::startOnOffRepeat(bool iOutput)
     // if repeat is already active, we wait until next cycle
     if (iOutput)
     {
-        if ((pCurrentPipeline & PIP_ON_REPEAT) == 0)
+        if ((pCurrentPipeline() & PIP_ON_REPEAT) == 0)
         {
-            pRepeatOnOffDelay = millis();
-            pCurrentPipeline &= ~PIP_OFF_REPEAT;
+            pCurrentPipeline() &= ~PIP_OFF_REPEAT;
             processOutput(iOutput);
-            if (getIntParam(LOG_fORepeatOn) > 0) {
-                pCurrentPipeline |= PIP_ON_REPEAT;
+            if (getParams().onRepeat > 0) {
+                startDelay(DLY_ON_OFF_REPEAT, getParams().onRepeat);
+                startPipeline(PIP_ON_REPEAT);
 #if LOGIC_TRACE
                 if (debugFilter())
                 {
-                    channelDebug("startOnRepeat: Every %0.1f s\n", getIntParam(LOG_fORepeatOn) / 10.0);
+                    channelDebug("startOnRepeat: Every %0.1f s\n", getParams().onRepeat / 1000.0);
                 }
 #endif
             }
@@ -1505,17 +1684,17 @@ void LogicChannel::startOnOffRepeat(bool iOutput)
     }
     else
     {
-        if ((pCurrentPipeline & PIP_OFF_REPEAT) == 0)
+        if ((pCurrentPipeline() & PIP_OFF_REPEAT) == 0)
         {
-            pRepeatOnOffDelay = millis();
-            pCurrentPipeline &= ~PIP_ON_REPEAT;
+            pCurrentPipeline() &= ~PIP_ON_REPEAT;
             processOutput(iOutput);
-            if (getIntParam(LOG_fORepeatOff) > 0) {
-                pCurrentPipeline |= PIP_OFF_REPEAT;
+            if (getParams().offRepeat > 0) {
+                startDelay(DLY_ON_OFF_REPEAT, getParams().offRepeat);
+                startPipeline(PIP_OFF_REPEAT);
 #if LOGIC_TRACE
                 if (debugFilter())
                 {
-                    channelDebug("startOffRepeat: Every %0.1f s\n", getIntParam(LOG_fORepeatOff) / 10.0);
+                    channelDebug("startOffRepeat: Every %0.1f s\n", getParams().offRepeat / 1000.0);
                 }
 #endif
             }
@@ -1530,72 +1709,76 @@ void LogicChannel::processOnOffRepeat()
 
     // we can handle On/Off repeat in one method, because they are alternative and never
     // set both in parallel
-    if (pCurrentPipeline & PIP_ON_REPEAT)
+    if (pCurrentPipeline() & PIP_ON_REPEAT)
     {
-        lRepeat = getIntParam(LOG_fORepeatOn) * 100;
+        lRepeat = getParams().onRepeat;
         lValue = true;
     }
-    if (pCurrentPipeline & PIP_OFF_REPEAT)
+    if (pCurrentPipeline() & PIP_OFF_REPEAT)
     {
-        lRepeat = getIntParam(LOG_fORepeatOff) * 100;
+        lRepeat = getParams().offRepeat;
         lValue = false;
     }
 
-    if (delayCheck(pRepeatOnOffDelay, lRepeat))
+    if (checkDelayExpired(DLY_ON_OFF_REPEAT))
     {
 #if LOGIC_TRACE
         if (debugFilter())
         {
             if (lValue)
             {
-                channelDebug("processOnRepeat: After %0.1f s\n", getIntParam(LOG_fORepeatOn) / 10.0);
+                channelDebug("processOnRepeat: After %0.1f s\n", getParams().onRepeat / 1000.0);
             }
             else
             {
-                channelDebug("processOffRepeat: After %0.1f s\n", getIntParam(LOG_fORepeatOff) / 10.0);
+                channelDebug("processOffRepeat: After %0.1f s\n", getParams().offRepeat / 1000.0);
             }
         }
 #endif
         // delay time is over, we repeat the output
         processOutput(lValue);
         // and we restart repeat counter
-        pRepeatOnOffDelay = millis();
+        startDelay(DLY_ON_OFF_REPEAT, lRepeat);
     }
 }
 
-// we trigger all associated internal inputs with the new value
-void LogicChannel::processInternalInputs(uint8_t iChannelId, bool iValue)
+// returns the channel (1-based), which is connected to an internal input, 0 if the input is inactive
+uint8_t LogicChannel::getInternalInputSource(uint8_t iIOIndex)
+{
+    if (iIOIndex == BIT_INT_INPUT_1)
+        return (getByteParam(LOG_fI1) >> LOG_fI1Shift) ? getByteParam(LOG_fI1Function) : 0;
+    if (iIOIndex == BIT_INT_INPUT_2)
+        return (getByteParam(LOG_fI2) & LOG_fI2Mask) ? getByteParam(LOG_fI2Function) : 0;
+    return 0;
+}
+
+// we trigger an internal input, which is connected to the output of an other channel
+void LogicChannel::processInternalInput(uint8_t iIOIndex, bool iValue)
 {
-    uint8_t lInput1 = getByteParam(LOG_fI1) >> LOG_fI1Shift;
-    if (lInput1 > 0)
-    {
-        uint8_t lFunction1 = getByteParam(LOG_fI1Function);
-        if (lFunction1 == (iChannelId + 1))
-        {
 #if LOGIC_TRACE
-            if (debugFilter())
-            {
-                channelDebug("processInternalInputs: Input I1, Value %i\n", iValue);
-            }
-#endif
-            startLogic(BIT_INT_INPUT_1, iValue);
-        }
-    }
-    uint8_t lInput2 = getByteParam(LOG_fI2) & LOG_fI2Mask;
-    if (lInput2 > 0)
+    if (debugFilter())
     {
-        uint8_t lFunction2 = getByteParam(LOG_fI2Function);
-        if (lFunction2 == (iChannelId + 1))
-        {
-#if LOGIC_TRACE
-            if (debugFilter())
-            {
-                channelDebug("processInternalInputs: Input I2, Value %i\n", iValue);
-            }
-#endif
-            startLogic(BIT_INT_INPUT_2, iValue);
-        }
+        channelDebug("processInternalInputs: Input %s, Value %i\n", (iIOIndex == BIT_INT_INPUT_1) ? "I1" : "I2", iValue);
     }
+#endif
+    startLogic(iIOIndex, iValue);
+}
+
+uint8_t LogicChannel::getChannelId()
+{
+    return mChannelId;
+}
+
+bool LogicChannel::isRunning()
+{
+    return (pCurrentPipeline() & PIP_RUNNING);
+}
+
+// AND, OR and EXOR are evaluated for all channels at once by Logic
+bool LogicChannel::isBatchLogic()
+{
+    uint8_t lLogic = getParams().logic;
+    return (lLogic == VAL_Logic_And || lLogic == VAL_Logic_Or || lLogic == VAL_Logic_ExOr);
 }
 
 bool LogicChannel::processDiagnoseCommand(char *cBuffer)
@@ -1606,8 +1789,8 @@ bool LogicChannel::processDiagnoseCommand(char *cBuffer)
         case 'l': {
             char v[5];
             // here we find the last IO state
-            uint8_t lValidInput = pValidActiveIO & BIT_INPUT_MASK;
-            uint8_t lCurrentIO = pCurrentIODebug & 0x1F;
+            uint8_t lValidInput = pValidActiveIO() & BIT_INPUT_MASK;
+            uint8_t lCurrentIO = pCurrentIODebug() & 0x1F;
             // input values
             for (uint8_t i = 0; i < 4; i++)
             {
@@ -1625,7 +1808,7 @@ bool LogicChannel::processDiagnoseCommand(char *cBuffer)
                 lCurrentIO >>= 1;
             }
             // output value
-            if ((pCurrentPipeline & PIP_RUNNING) && (pCurrentIn & BIT_FIRST_PROCESSING))
+            if ((pCurrentPipeline() & PIP_RUNNING) && (pCurrentIn() & BIT_FIRST_PROCESSING))
             {
                 v[4] = (lCurrentIO & 1) ? '1' : '0';
             }
@@ -1656,7 +1839,7 @@ void LogicChannel::processOutput(bool iValue)
 #endif
     if (iValue)
     {
-        uint8_t lOn = getByteParam(LOG_fOOn);
+        uint8_t lOn = getParams().onOutput;
         switch (lOn)
         {
             case VAL_Out_Constant:
@@ -1690,7 +1873,7 @@ void LogicChannel::processOutput(bool iValue)
     }
     else
     {
-        uint8_t lOff = getByteParam(LOG_fOOff);
+        uint8_t lOff = getParams().offOutput;
         switch (lOff)
         {
             case VAL_Out_Constant:
@@ -1726,70 +1909,51 @@ void LogicChannel::processOutput(bool iValue)
 
 bool LogicChannel::checkDpt(uint8_t iIOIndex, uint8_t iDpt)
 {
-    uint16_t lParam;
+    uint8_t lDpt;
     switch (iIOIndex)
     {
         case IO_Input1:
-            lParam = LOG_fE1Dpt;
-            break;
         case IO_Input2:
-            lParam = LOG_fE2Dpt;
+            lDpt = getParams().inputDpt[iIOIndex - 1];
             break;
         case IO_Output:
-            lParam = LOG_fODpt;
+            lDpt = getParams().outputDpt;
             break;
         default:
             return false;
             break;
     }
-    uint8_t lDpt = getByteParam(lParam);
     return lDpt == iDpt;
 }
 
 bool LogicChannel::readOneInputFromEEPROM(uint8_t iIOIndex)
 {
-#ifdef I2C_EEPROM_DEVICE_ADDRESSS
-    EepromManager *lEEPROM = sLogic->getEEPROM();
-    // first check, if EEPROM contains valid values
-    if (!lEEPROM->isValid())
-        return false;
-    // Now check, if the DPT for requested KO is valid
-    // DPT might have changed due to new programming after last save
-    uint16_t lAddress = (SAVE_BUFFER_START_PAGE + 1) * 32 + mChannelId * 2 + iIOIndex - 1;
-    lEEPROM->prepareRead(lAddress, 1);
-    uint8_t lSavedDpt = Wire.read();
-    if (!checkDpt(iIOIndex, lSavedDpt))
+    // all saved values were read at once into restore buffer, there are no values,
+    // if no snapshot slot is valid or layout changed due to new programming after last save
+    uint8_t *lData = sLogic->getRestoreValue(mChannelId, iIOIndex);
+    if (lData == nullptr)
         return false;
-
-    // if the dpt is ok, we get the ko value
-    lAddress = (SAVE_BUFFER_START_PAGE + 9) * 32 + mChannelId * 8 + (iIOIndex - 1) * 4;
+    uint8_t lSize = sLogic->getSaveSize(mChannelId, iIOIndex);
     GroupObject *lKo = getKo(iIOIndex);
-    lEEPROM->prepareRead(lAddress, lKo->valueSize());
-    int lIndex = 0;
-    while (Wire.available() && lIndex < 4)
-        lKo->valueRef()[lIndex++] = Wire.read();
+    for (uint8_t lIndex = 0; lIndex < lSize; lIndex++)
+        lKo->valueRef()[lIndex] = lData[lIndex];
     return true;
-#else
-    return false;
-#endif
 }
 
-void LogicChannel::writeSingleDptToEEPROM(uint8_t iIOIndex)
+// true, if input value is written to EEPROM on save
+bool LogicChannel::isInputSavedInEEPROM(uint8_t iIOIndex)
 {
-#ifdef I2C_EEPROM_DEVICE_ADDRESSS
-    uint8_t lDpt = 0xFF;
-    if (isInputActive(iIOIndex))
-    {
-        // now get input default value
-        uint8_t lParInput = getByteParam(iIOIndex == 1 ? LOG_fE1Default : LOG_fE2Default);
-        if (lParInput & VAL_InputDefault_EEPROM)
-        {
-            // if the default is EEPROM, we get correct dpt
-            lDpt = getByteParam(iIOIndex == 1 ? LOG_fE1Dpt : LOG_fE2Dpt);
-        }
-    }
-    Wire.write(lDpt);
-#endif
+    return isInputActive(iIOIndex) && (getParams().inputDefault[iIOIndex - 1] & VAL_InputDefault_EEPROM);
+}
+
+// number of bytes saved in EEPROM for this input (0, if not saved) and its dpt
+uint8_t LogicChannel::getSaveLayout(uint8_t iIOIndex, uint8_t &cDpt)
+{
+    cDpt = getParams().inputDpt[iIOIndex - 1];
+    if (!isInputSavedInEEPROM(iIOIndex))
+        return 0;
+    uint8_t lSize = getKo(iIOIndex)->valueSize();
+    return (lSize > 4) ? 4 : lSize;
 }
 
 // retutns true, if any DPT from EEPROM does not fit to according input DPT.
@@ -1799,12 +1963,13 @@ bool LogicChannel::prepareChannel()
     bool lResult = false;
     bool lInput1EEPROM = false;
     bool lInput2EEPROM = false;
-    uint8_t lLogicFunction = (getByteParam(LOG_fDisable) & LOG_fDisableMask) ? 0 : getByteParam(LOG_fLogic);
+    decodeParams();
+    uint8_t lLogicFunction = getParams().logic;
 
     if (lLogicFunction == 5)
     {
         // timer implementation, timer is on ext input 2
-        pValidActiveIO |= BIT_EXT_INPUT_2 >> 4;
+        pValidActiveIO() |= BIT_EXT_INPUT_2 >> 4;
         startStartup();
     }
     else if (lLogicFunction > 0)
@@ -1814,13 +1979,13 @@ bool LogicChannel::prepareChannel()
         if (isInputActive(IO_Input1))
         {
             // input is active, we set according flag
-            pValidActiveIO |= BIT_EXT_INPUT_1 << 4;
+            pValidActiveIO() |= BIT_EXT_INPUT_1 << 4;
             // prepare input for cyclic read
-            pInputProcessing.repeatInput1Delay = getIntParam(LOG_fE1Repeat);
-            if (pInputProcessing.repeatInput1Delay)
+            uint32_t lRepeatTime = getParams().inputRepeat[0];
+            if (lRepeatTime)
             {
-                pInputProcessing.repeatInput1Delay = millis();
-                pCurrentPipeline |= PIP_REPEAT_INPUT1;
+                startDelay(DLY_REPEAT_INPUT1, lRepeatTime);
+                startPipeline(PIP_REPEAT_INPUT1);
             }
             // now set input default value
             uint8_t lParInput = getByteParam(LOG_fE1Default);
@@ -1838,8 +2003,8 @@ bool LogicChannel::prepareChannel()
             {
                 case VAL_InputDefault_Read:
                     /* to read immediately we activate repeated read pipeline with 0 delay */
-                    pInputProcessing.repeatInput1Delay = 0;
-                    pCurrentPipeline |= PIP_REPEAT_INPUT1;
+                    startDelay(DLY_REPEAT_INPUT1, 0);
+                    startPipeline(PIP_REPEAT_INPUT1);
                     break;
 
                 case VAL_InputDefault_False:
@@ -1861,13 +2026,13 @@ bool LogicChannel::prepareChannel()
         if (isInputActive(IO_Input2))
         {
             // input is active, we set according flag
-            pValidActiveIO |= BIT_EXT_INPUT_2 << 4;
+            pValidActiveIO() |= BIT_EXT_INPUT_2 << 4;
             // prepare input for cyclic read
-            pInputProcessing.repeatInput2Delay = getIntParam(LOG_fE2Repeat);
-            if (pInputProcessing.repeatInput2Delay)
+            uint32_t lRepeatTime = getParams().inputRepeat[1];
+            if (lRepeatTime)
             {
-                pInputProcessing.repeatInput2Delay = millis();
-                pCurrentPipeline |= PIP_REPEAT_INPUT2;
+                startDelay(DLY_REPEAT_INPUT2, lRepeatTime);
+                startPipeline(PIP_REPEAT_INPUT2);
             }
             uint8_t lParInput = getByteParam(LOG_fE2Default);
             // shoud default be fetched from EEPROM
@@ -1884,8 +2049,8 @@ bool LogicChannel::prepareChannel()
             {
                 case VAL_InputDefault_Read:
                     /* to read immediately we activate repeated read pipeline with 0 delay */
-                    pInputProcessing.repeatInput2Delay = 0;
-                    pCurrentPipeline |= PIP_REPEAT_INPUT2;
+                    startDelay(DLY_REPEAT_INPUT2, 0);
+                    startPipeline(PIP_REPEAT_INPUT2);
                     break;
 
                 case VAL_InputDefault_False:
@@ -1909,7 +2074,7 @@ bool LogicChannel::prepareChannel()
         if (lIsActive > 0)
         {
             // input is active, we set according flag
-            pValidActiveIO |= BIT_INT_INPUT_1 << 4;
+            pValidActiveIO() |= BIT_INT_INPUT_1 << 4;
         }
         // internal input 2
         // first check, if input is active
@@ -1917,8 +2082,11 @@ bool LogicChannel::prepareChannel()
         if (lIsActive > 0)
         {
             // input is active, we set according flag
-            pValidActiveIO |= BIT_INT_INPUT_2 << 4;
+            pValidActiveIO() |= BIT_INT_INPUT_2 << 4;
         }
+        // register simple logic for batch evaluation
+        if (isBatchLogic())
+            sLogic->addToLogicBatch(mChannelId, lLogicFunction, pValidActiveIO() >> 4, (getParams().calculate & LOG_fCalculateMask) == 0);
         // we set the startup delay
         startStartup();
         // we trigger input processing, if there are values from EEPROM
@@ -1930,312 +2098,378 @@ bool LogicChannel::prepareChannel()
     return lResult;
 }
 
+// processing function for each stage, in order of PIP_* bits
+const LogicChannel::PipelineStage LogicChannel::cPipelineStages[PIP_STAGE_COUNT] = {
+    &LogicChannel::processOnOffRepeat,  // PIP_ON_REPEAT
+    &LogicChannel::processOnOffRepeat,  // PIP_OFF_REPEAT
+    &LogicChannel::processOutputFilter, // PIP_OUTPUT_FILTER_ON
+    &LogicChannel::processOutputFilter, // PIP_OUTPUT_FILTER_OFF
+    &LogicChannel::processOffDelay,     // PIP_OFF_DELAY
+    &LogicChannel::processOnDelay,      // PIP_ON_DELAY
+    &LogicChannel::processStairlight,   // PIP_STAIRLIGHT
+    &LogicChannel::processBlink,        // PIP_BLINK
+    &LogicChannel::processLogic,        // PIP_LOGIC_EXECUTE
+    &LogicChannel::processConvertInput1, // PIP_CONVERT_INPUT1
+    &LogicChannel::processConvertInput2, // PIP_CONVERT_INPUT2
+    &LogicChannel::processRepeatInput1, // PIP_REPEAT_INPUT1
+    &LogicChannel::processRepeatInput2, // PIP_REPEAT_INPUT2
+    &LogicChannel::processTimerInput};  // PIP_TIMER_INPUT
+
 void LogicChannel::loop()
 {
     if (!knx.configured())
         return;
 
-    if (pCurrentPipeline & PIP_STARTUP)
+    if (pCurrentPipeline() & PIP_STARTUP)
         processStartup();
-    if (pCurrentPipeline & PIP_TIMER_RESTORE_STATE)
-        processTimerRestoreState(sTimerRestore);
 
     // do no further processing until channel passed its startup time
-    if (pCurrentPipeline & PIP_RUNNING)
+    if (pCurrentPipeline() & PIP_RUNNING)
     {
-        // we revert the processing order for pipeline events
+        // we visit just stages, which are pending now, in reverse order of the pipeline.
+        // A stage started during this pass is processed in next pass,
         // this reduces the chance to have a long running
         // sequence of funtions because of according pipeline settings
-        // On/Off repeat pipeline
-        if (pCurrentPipeline & (PIP_ON_REPEAT | PIP_OFF_REPEAT))
-            processOnOffRepeat();
-        // Output Filter pipeline
-        if (pCurrentPipeline & (PIP_OUTPUT_FILTER_ON | PIP_OUTPUT_FILTER_OFF))
-            processOutputFilter();
-        // Off delay pipeline
-        if (pCurrentPipeline & PIP_OFF_DELAY)
-            processOffDelay();
-        // On delay pipeline
-        if (pCurrentPipeline & PIP_ON_DELAY)
-            processOnDelay();
-        // stairlight pipeline
-        if (pCurrentPipeline & PIP_STAIRLIGHT)
-            processStairlight();
-        // blink pipeline (has to be "after" stairlight)
-        if (pCurrentPipeline & PIP_BLINK)
-            processBlink();
-        // Logic execution pipeline
-        if (pCurrentPipeline & PIP_LOGIC_EXECUTE)
-            processLogic();
-        // convert input pipeline
-        if (pCurrentPipeline & PIP_CONVERT_INPUT1)
-            processConvertInput(IO_Input1);
-        if (pCurrentPipeline & PIP_CONVERT_INPUT2)
-            processConvertInput(IO_Input2);
-        // repeat input pipeline
-        if (pCurrentPipeline & PIP_REPEAT_INPUT1)
-            processRepeatInput1();
-        if (pCurrentPipeline & PIP_REPEAT_INPUT2)
-            processRepeatInput2();
-        if (pCurrentPipeline & PIP_TIMER_INPUT)
-            processTimerInput();
+        uint32_t lPending = pCurrentPipeline() & PIP_STAGE_MASK;
+        while (lPending)
+        {
+            uint8_t lStage = __builtin_ctz(lPending);
+            lPending &= lPending - 1;
+            // a previous stage might have stopped this one
+            if (pCurrentPipeline() & (1UL << lStage))
+                (this->*cPipelineStages[lStage])();
+        }
+    }
+    // forget expired delays of pipeline steps, which were stopped meanwhile
+    if (pExpiredDelays())
+    {
+        for (uint8_t lDelay = 0; lDelay < DLY_COUNT; lDelay++)
+            if ((pCurrentPipeline() & cDelayPipeline[lDelay]) == 0)
+                pExpiredDelays() &= ~(1 << lDelay);
     }
 }
 
 // Start of Timer implementation
+// all timer parameters are compiled once into a timer program, live timer processing
+// and timer restore evaluate this program the same way and do not read parameters anymore
+void LogicChannel::compileTimerProgram()
+{
+    if (mTimerProgram == nullptr)
+        mTimerProgram = new sTimerProgram;
+    sTimerProgram &lProgram = *mTimerProgram;
+    lProgram.isYearTimer = (getByteParam(LOG_fTYearDay) & LOG_fTYearDayMask);
+    lProgram.vacation = (getByteParam(LOG_fTVacation) & LOG_fTVacationMask) >> LOG_fTVacationShift;
+    lProgram.holiday = (getByteParam(LOG_fTHoliday) & LOG_fTHolidayMask) >> LOG_fTHolidayShift;
+    lProgram.needsSunInfo = false;
+    lProgram.weekdays = 0;
+    lProgram.count = 0;
+    uint8_t lCountTimer = lProgram.isYearTimer ? VAL_Tim_YearTimerCount : VAL_Tim_DayTimerCount;
+    uint32_t lTimerFunctions = getIntParam(LOG_fTd1DuskDawn);
+    for (uint8_t lTimerIndex = 0; lTimerIndex < lCountTimer; lTimerIndex++)
+    {
+        uint8_t lTimerFunction = (lTimerFunctions >> (28 - lTimerIndex * 4)) & 0xF;
+        if (lTimerFunction == VAL_Tim_Inactive)
+            continue;
+        sTimerEntry &lEntry = lProgram.entry[lProgram.count++];
+        uint16_t lBitfield = getWordParam(LOG_fTd1Value + 2 * lTimerIndex);
+        lEntry.function = lTimerFunction;
+        lEntry.value = lBitfield & 0x8000;
+        lEntry.hour = (lBitfield & 0x3E00) >> 9;
+        lEntry.minute = (lBitfield & 0x01F8) >> 3;
+        lEntry.weekday = lBitfield & 0x7;
+        lEntry.month = 0;
+        lEntry.dayWeekday = 0;
+        lProgram.needsSunInfo = lProgram.needsSunInfo || (lTimerFunction != VAL_Tim_PointInTime);
+        // our weekday format is 1=Monday, ..., 7=Sunday, 0=any, bit n in weekdays is weekday n (0 = sunday)
+        if (lProgram.isYearTimer)
+        {
+            lEntry.month = (getByteParam(LOG_fTy1Month + 2 * lTimerIndex) >> 4) & 0xF;
+            lEntry.dayWeekday = getByteParam(LOG_fTy1Day + 2 * lTimerIndex);
+            if ((lEntry.dayWeekday & 1) == 0 || lEntry.dayWeekday == 0xFF)
+                lProgram.weekdays = 0x7F;
+            else
+                for (uint8_t lWeekday = 1; lWeekday < 8; lWeekday++)
+                    if (lEntry.dayWeekday & (0x100 >> lWeekday))
+                        lProgram.weekdays |= 1 << (lWeekday % 7);
+        }
+        else
+        {
+            lProgram.weekdays |= (lEntry.weekday == 0) ? 0x7F : 1 << (lEntry.weekday % 7);
+        }
+    }
+}
+
+sTimerProgram &LogicChannel::getTimerProgram()
+{
+    getParams();
+    return *mTimerProgram;
+}
+
 void LogicChannel::startTimerInput()
 {
-    uint8_t lLogicFunction = (getByteParam(LOG_fDisable) & LOG_fDisableMask) ? 0 : getByteParam(LOG_fLogic);
+    uint8_t lLogicFunction = getParams().logic;
     if (lLogicFunction == VAL_Logic_Timer && sTimer.isTimerValid())
     {
-        pCurrentPipeline |= PIP_TIMER_INPUT;
+        startPipeline(PIP_TIMER_INPUT);
     }
 }
 
-// called every minute, finds the next timer to process and marks it
+// called for the minute, at which this channel might switch
 void LogicChannel::processTimerInput()
 {
-    bool lIsYearTimer = (getByteParam(LOG_fTYearDay) & LOG_fTYearDayMask);
-    uint8_t lCountTimer = lIsYearTimer ? VAL_Tim_YearTimerCount : VAL_Tim_DayTimerCount; // there are 4 year timer or 8 day timer
-    bool lToday;                              // if it is a day timer lToday=true
-    bool lResult = false;
     bool lValue;
+    bool lHandleAsSunday;
+    uint16_t lMinute = sTimer.getHour() * 60 + sTimer.getMinute();
+    bool lIsVacation = knx.getGroupObject(LOG_KoVacation).value(getDPT(VAL_DPT_1));
+    if (checkTimerDay(sTimer, lIsVacation, lHandleAsSunday) && evaluateTimerProgram(sTimer, lHandleAsSunday, lMinute, false, lValue) == lMinute)
+    {
+#if LOGIC_TRACE
+        if (debugFilter())
+        {
+            channelDebug("startTimerInput: Value %i\n", lValue);
+        }
+#endif
+        startLogic(BIT_EXT_INPUT_2, lValue);
+        // if a timer is executed, it has not to be restored anymore
+        pCurrentPipeline() &= ~PIP_TIMER_RESTORE_STATE;
+    }
+    // we wait for next timer execution
+    pCurrentPipeline() &= ~PIP_TIMER_INPUT;
+}
+
+// first we process settings valid for whole timer,
+// returns false, if vacation or holiday settings prevent timer evaluation on the day of iTimer
+// or if no timer can switch on this weekday
+bool LogicChannel::checkTimerDay(Timer &iTimer, bool iIsVacation, bool &cHandleAsSunday)
+{
+    sTimerProgram &lProgram = getTimerProgram();
     bool lEvaluate = true;
-    // first we process settings valid for whole timer
     // vacation
-    bool lIsVacation = knx.getGroupObject(LOG_KoVacation).value(getDPT(VAL_DPT_1));
-    uint8_t lVacationSetting = (getByteParam(LOG_fTVacation) & LOG_fTVacationMask) >> LOG_fTVacationShift;
-    if (lVacationSetting == VAL_Tim_Special_No && lIsVacation)
+    if (lProgram.vacation == VAL_Tim_Special_No && iIsVacation)
         lEvaluate = false;
-    if (lVacationSetting == VAL_Tim_Special_Skip || lVacationSetting == VAL_Tim_Special_Sunday)
-        lEvaluate = true;
-    if (lVacationSetting == VAL_Tim_Special_Only)
-        lEvaluate = lIsVacation;
+    if (lProgram.vacation == VAL_Tim_Special_Only)
+        lEvaluate = iIsVacation;
 
     // holiday
-    uint8_t lHolidaySetting = (getByteParam(LOG_fTHoliday) & LOG_fTHolidayMask) >> LOG_fTHolidayShift;
-    if (lEvaluate) {
-        if (lHolidaySetting == VAL_Tim_Special_No && (sTimer.holidayToday() > 0))
+    bool lIsHoliday = (lProgram.holiday != VAL_Tim_Special_Skip) && (iTimer.holidayToday() > 0);
+    if (lEvaluate)
+    {
+        if (lProgram.holiday == VAL_Tim_Special_No && lIsHoliday)
             lEvaluate = false;
-        if (lHolidaySetting == VAL_Tim_Special_Skip || lHolidaySetting == VAL_Tim_Special_Sunday)
-            lEvaluate = true;
-        if (lHolidaySetting == VAL_Tim_Special_Only)
-            lEvaluate = (sTimer.holidayToday() > 0);
+        if (lProgram.holiday == VAL_Tim_Special_Only)
+            lEvaluate = lIsHoliday;
     }
 
-    if (lEvaluate)
-    {
+    cHandleAsSunday = (lProgram.holiday == VAL_Tim_Special_Sunday && lIsHoliday) ||
+                      (lProgram.vacation == VAL_Tim_Special_Sunday && iIsVacation);
+    // a timer without any timer for this weekday cannot switch on this day
+    if ((lProgram.weekdays & (1 << iTimer.getWeekday())) == 0 && !(cHandleAsSunday && (lProgram.weekdays & 1)))
+        lEvaluate = false;
+    return lEvaluate;
+}
 
-        bool lHandleAsSunday = (lHolidaySetting == VAL_Tim_Special_Sunday && (sTimer.holidayToday() > 0)) ||
-                               (lVacationSetting == VAL_Tim_Special_Sunday && lIsVacation);
+bool LogicChannel::isTimerChannel()
+{
+    return getParams().logic == VAL_Logic_Timer;
+}
 
-        // loop through all timer
-        uint32_t lTimerFunctions = getIntParam(LOG_fTd1DuskDawn);
-        for (uint8_t lTimerIndex = 0; lTimerIndex < lCountTimer; lTimerIndex++)
-        {
-            // get timer function code
-            uint8_t lTimerFunction = (lTimerFunctions >> (28 - lTimerIndex * 4)) & 0xF;
-            if (lTimerFunction)
-            {
-                // timer function is active
-                lToday = !lIsYearTimer || checkTimerToday(sTimer, lTimerIndex, lHandleAsSunday);
-                if (lToday)
-                {
-                    uint16_t lBitfield = getWordParam(LOG_fTd1Value + 2 * lTimerIndex);
-                    lValue = lBitfield & 0x8000;
-                    switch (lTimerFunction)
-                    {
-                        case VAL_Tim_PointInTime:
-                            lResult = checkPointInTime(sTimer, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday);
-                            break;
-                        case VAL_Tim_Sunrise_Plus:
-                            lResult = checkSunAbs(sTimer, SUN_SUNRISE, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, false);
-                            break;
-                        case VAL_Tim_Sunrise_Minus:
-                            lResult = checkSunAbs(sTimer, SUN_SUNRISE, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, true);
-                            break;
-                        case VAL_Tim_Sunset_Plus:
-                            lResult = checkSunAbs(sTimer, SUN_SUNSET, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, false);
-                            break;
-                        case VAL_Tim_Sunset_Minus:
-                            lResult = checkSunAbs(sTimer, SUN_SUNSET, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, true);
-                            break;
-                        case VAL_Tim_Sunrise_Earliest:
-                            lResult = checkSunLimit(sTimer, SUN_SUNRISE, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, false);
-                            break;
-                        case VAL_Tim_Sunrise_Latest:
-                            lResult = checkSunLimit(sTimer, SUN_SUNRISE, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, true);
-                            break;
-                        case VAL_Tim_Sunset_Earliest:
-                            lResult = checkSunLimit(sTimer, SUN_SUNSET, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, false);
-                            break;
-                        case VAL_Tim_Sunset_Latest:
-                            lResult = checkSunLimit(sTimer, SUN_SUNSET, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, true);
-                            break;
-                        default:
-                            break;
-                    }
-                }
-            }
-            if (lResult)
-                break;
-        }
-        if (lResult)
+// earliest minute of day (not before iFromMinute), at which one of the timers switches today.
+// Returns VAL_Tim_NoSwitchToday, if no timer switches anymore today.
+uint16_t LogicChannel::getNextTimerMinute(uint16_t iFromMinute)
+{
+    bool lValue;
+    bool lHandleAsSunday;
+    bool lIsVacation = knx.getGroupObject(LOG_KoVacation).value(getDPT(VAL_DPT_1));
+    if (!checkTimerDay(sTimer, lIsVacation, lHandleAsSunday))
+        return VAL_Tim_NoSwitchToday;
+    int16_t lMinute = evaluateTimerProgram(sTimer, lHandleAsSunday, iFromMinute, false, lValue);
+    return (lMinute < 0) ? VAL_Tim_NoSwitchToday : lMinute;
+}
+
+// Evaluates timer program for the day of iTimer, this is the only place where timers are interpreted.
+// Returns the first minute of day >= iMinute, at which a timer switches, or with iLatest
+// the last minute of day <= iMinute (iMinute = 1439 gives the value at end of day).
+// cValue is the value of this timer, -1 is returned, if no timer switches in this range.
+int16_t LogicChannel::evaluateTimerProgram(Timer &iTimer, bool iHandleAsSunday, uint16_t iMinute, bool iLatest, bool &cValue)
+{
+    sTimerProgram &lProgram = getTimerProgram();
+    int16_t lResult = -1;
+    for (uint8_t lIndex = 0; lIndex < lProgram.count; lIndex++)
+    {
+        sTimerEntry &lEntry = lProgram.entry[lIndex];
+        uint8_t lHour;
+        uint8_t lMinute;
+        if (!getTimerEntryTime(iTimer, lEntry, iHandleAsSunday, lHour, lMinute))
+            continue;
+        int16_t lTimerMinute = findTimerMinute(lHour, lMinute, iMinute, iLatest);
+        if (lTimerMinute < 0)
+            continue;
+        // on same minute the first timer wins
+        if (lResult < 0 || (iLatest ? lTimerMinute > lResult : lTimerMinute < lResult))
         {
-#if LOGIC_TRACE
-            if (debugFilter())
-            {
-                channelDebug("startTimerInput: Value %i\n", lValue);
-            }
-#endif
-            startLogic(BIT_EXT_INPUT_2, lValue);
-            // if a timer is executed, it has not to be restored anymore
-            pCurrentPipeline &= ~PIP_TIMER_RESTORE_STATE;
+            lResult = lTimerMinute;
+            cValue = lEntry.value;
         }
     }
-    // we wait for next timer execution
-    pCurrentPipeline &= ~PIP_TIMER_INPUT;
+    return lResult;
 }
 
-// checks if timer is valid today
-// just called for year timer
-bool LogicChannel::checkTimerToday(Timer &iTimer, uint8_t iTimerIndex, bool iHandleAsSunday)
+// switch time of a timer for the day of iTimer, hour and minute may be
+// VAL_Tim_Every_Hour or VAL_Tim_Every_Minute. Returns false, if timer does not switch on this day.
+bool LogicChannel::getTimerEntryTime(Timer &iTimer, sTimerEntry &iEntry, bool iHandleAsSunday, uint8_t &cHour, uint8_t &cMinute)
 {
-    bool lResult = false;
-    // check for valid index
-    if (iTimerIndex < 4)
+    if (mTimerProgram->isYearTimer ? !checkTimerToday(iTimer, iEntry, iHandleAsSunday) : !checkWeekday(iTimer, iEntry.weekday, iHandleAsSunday))
+        return false;
+    cHour = iEntry.hour;
+    cMinute = iEntry.minute;
+    uint8_t lSunInfo = (iEntry.function >= VAL_Tim_Sunset_Plus) ? SUN_SUNSET : SUN_SUNRISE;
+    switch (iEntry.function)
     {
-        // now we check correct month
-        uint8_t lMonth = (getByteParam(LOG_fTy1Month + 2 * iTimerIndex) >> 4) & 0xF;
-        if (lMonth == 0 || lMonth == iTimer.getMonth())
+        case VAL_Tim_PointInTime:
+            return true;
+        case VAL_Tim_Sunrise_Plus:
+        case VAL_Tim_Sunrise_Minus:
+        case VAL_Tim_Sunset_Plus:
+        case VAL_Tim_Sunset_Minus:
+        {
+            // hour and minute are an offset to sunrise/sunset
+            sTime *lSun = iTimer.getSunInfo(lSunInfo);
+            int16_t lOffset = iEntry.hour * 60 + iEntry.minute;
+            if (iEntry.function == VAL_Tim_Sunrise_Minus || iEntry.function == VAL_Tim_Sunset_Minus)
+                lOffset = -lOffset;
+            int16_t lMinuteOfDay = (lSun->hour * 60 + lSun->minute + lOffset + 1440) % 1440;
+            cHour = lMinuteOfDay / 60;
+            cMinute = lMinuteOfDay % 60;
+            return true;
+        }
+        case VAL_Tim_Sunrise_Earliest:
+        case VAL_Tim_Sunrise_Latest:
+        case VAL_Tim_Sunset_Earliest:
+        case VAL_Tim_Sunset_Latest:
         {
-            // we have the correct month, check correct day
-            uint8_t lDayWeekday = (getByteParam(LOG_fTy1Day + 2 * iTimerIndex));
-            if (lDayWeekday & 1)
+            // hour and minute are a limit for sunrise/sunset
+            sTime *lSun = iTimer.getSunInfo(lSunInfo);
+            int8_t lCompare = (iEntry.function == VAL_Tim_Sunrise_Latest || iEntry.function == VAL_Tim_Sunset_Latest) ? -1 : 1; // else case means "Earliest"
+            if ((lSun->hour - cHour) * lCompare > 0)
             {
-                // Wochentag
-                if (lDayWeekday == 0xFF)
-                {
-                    // shortcut for 'every day'
-                    lResult = true;
-                }
-                else if (lDayWeekday > 1)
-                {
-                    for (uint8_t lWeekday = 1; lWeekday < 8; lWeekday++)
-                    {
-                        if (lDayWeekday & 0x80)
-                        {
-                            lResult = checkWeekday(iTimer, lWeekday, iHandleAsSunday);
-                            if (lResult)
-                                break;
-                        };
-                        lDayWeekday <<= 1;
-                    }
-                }
+                cHour = lSun->hour;
+                cMinute = lSun->minute;
             }
-            else
+            else if (lSun->hour == cHour && (lSun->minute - cMinute) * lCompare > 0)
             {
-                // Tag
-                lDayWeekday >>= 1;
-                lResult = (lDayWeekday == 0) || (lDayWeekday == iTimer.getDay());
+                cMinute = lSun->minute;
             }
+            return true;
         }
+        default:
+            return false;
     }
-    return lResult;
 }
 
-// iWeekday is in our format (1=Monday, ..., 7 = Sunday, 0=any)
-bool LogicChannel::checkWeekday(Timer &iTimer, uint8_t iWeekday, bool iHandleAsSunday)
+// first minute of day >= iMinuteOfDay (or with iLatest the last one <= iMinuteOfDay),
+// which matches iHour and iMinute, -1 if there is none
+int16_t LogicChannel::findTimerMinute(uint8_t iHour, uint8_t iMinute, uint16_t iMinuteOfDay, bool iLatest)
 {
-    if (iWeekday > 7)
-        return false;
-    if (iWeekday == 0)
+    uint8_t lHour = iMinuteOfDay / 60;
+    uint8_t lMinute = iMinuteOfDay % 60;
+    if ((iHour > 23 && iHour != VAL_Tim_Every_Hour) || (iMinute > 59 && iMinute != VAL_Tim_Every_Minute))
+        return -1;
+    if (iHour != VAL_Tim_Every_Hour && iHour != lHour)
     {
-        return true;
+        // another hour fits just, if it is not passed yet (or with iLatest, if it is passed)
+        if ((iHour > lHour) == iLatest)
+            return -1;
+        lHour = iHour;
+        lMinute = iLatest ? 59 : 0;
     }
-    if (iWeekday == 7)
+    if (iMinute != VAL_Tim_Every_Minute && iMinute != lMinute)
     {
-        iWeekday = 0;
-        if (iHandleAsSunday)
-            return true;
+        if ((iMinute > lMinute) == iLatest)
+        {
+            // minute is passed in this hour, for every hour we take the next (previous) hour
+            if (iHour != VAL_Tim_Every_Hour)
+                return -1;
+            lHour += iLatest ? -1 : 1;
+            if (lHour > 23)
+                return -1;
+        }
+        lMinute = iMinute;
     }
-    return iWeekday == iTimer.getWeekday();
+    return lHour * 60 + lMinute;
 }
 
-bool LogicChannel::checkTimerTime(Timer &iTimer, uint8_t iTimerIndex, uint16_t iBitfield, uint8_t iHour, uint8_t iMinute, bool iSkipWeekday, bool iHandleAsSunday)
+// checks if year timer is valid on the day of iTimer
+bool LogicChannel::checkTimerToday(Timer &iTimer, sTimerEntry &iEntry, bool iHandleAsSunday)
 {
     bool lResult = false;
-
-    // check correct timer index
-    if (iTimerIndex < 8)
+    // now we check correct month
+    if (iEntry.month == 0 || iEntry.month == iTimer.getMonth())
     {
-        if (iSkipWeekday || checkWeekday(iTimer, iBitfield & 0x7, iHandleAsSunday))
+        // we have the correct month, check correct day
+        uint8_t lDayWeekday = iEntry.dayWeekday;
+        if (lDayWeekday & 1)
         {
-            // check hour
-            if (iHour == 31 || iHour == iTimer.getHour())
+            // Wochentag
+            if (lDayWeekday == 0xFF)
+            {
+                // shortcut for 'every day'
+                lResult = true;
+            }
+            else if (lDayWeekday > 1)
             {
-                // check minute
-                if (iMinute == 63 || iMinute == iTimer.getMinute())
+                for (uint8_t lWeekday = 1; lWeekday < 8; lWeekday++)
                 {
-                    lResult = true;
+                    if (lDayWeekday & 0x80)
+                    {
+                        lResult = checkWeekday(iTimer, lWeekday, iHandleAsSunday);
+                        if (lResult)
+                            break;
+                    };
+                    lDayWeekday <<= 1;
                 }
             }
         }
+        else
+        {
+            // Tag
+            lDayWeekday >>= 1;
+            lResult = (lDayWeekday == 0) || (lDayWeekday == iTimer.getDay());
+        }
     }
     return lResult;
 }
 
-bool LogicChannel::checkPointInTime(Timer &iTimer, uint8_t iTimerIndex, uint16_t iBitfield, bool iSkipWeekday, bool iHandleAsSunday)
-{
-    uint8_t lHour = (iBitfield & 0x3E00) >> 9;
-    uint8_t lMinute = (iBitfield & 0x01F8) >> 3;
-    bool lResult = checkTimerTime(iTimer, iTimerIndex, iBitfield, lHour, lMinute, iSkipWeekday, iHandleAsSunday);
-    return lResult;
-}
-
-bool LogicChannel::checkSunAbs(Timer &iTimer, uint8_t iSunInfo, uint8_t iTimerIndex, uint16_t iBitfield, bool iSkipWeekday, bool iHandleAsSunday, bool iMinus)
-{
-    int8_t lFactor = (iMinus) ? -1 : 1;
-    uint8_t lHour = (iTimer.getSunInfo(iSunInfo)->hour + ((iBitfield & 0x3E00) >> 9) * lFactor) % 24;
-    uint8_t lMinute = (iTimer.getSunInfo(iSunInfo)->minute + ((iBitfield & 0x01F8) >> 3) * lFactor) % 60;
-    bool lResult = checkTimerTime(iTimer, iTimerIndex, iBitfield, lHour, lMinute, iSkipWeekday, iHandleAsSunday);
-    return lResult;
-}
-
-bool LogicChannel::checkSunLimit(Timer &iTimer, uint8_t iSunInfo, uint8_t iTimerIndex, uint16_t iBitfield, bool iSkipWeekday, bool iHandleAsSunday, bool iLatest)
+// iWeekday is in our format (1=Monday, ..., 7 = Sunday, 0=any)
+bool LogicChannel::checkWeekday(Timer &iTimer, uint8_t iWeekday, bool iHandleAsSunday)
 {
-    uint8_t lHour = ((iBitfield & 0x3E00) >> 9);
-    uint8_t lMinute = ((iBitfield & 0x01F8) >> 3);
-    int8_t lCompare = iLatest ? -1 : 1; // else case means "Earliest"
-    if ((iTimer.getSunInfo(iSunInfo)->hour - lHour) * lCompare > 0)
+    if (iWeekday > 7)
+        return false;
+    if (iWeekday == 0)
     {
-        lHour = iTimer.getSunInfo(iSunInfo)->hour;
-        lMinute = iTimer.getSunInfo(iSunInfo)->minute;
+        return true;
     }
-    else if (iTimer.getSunInfo(iSunInfo)->hour == lHour && (iTimer.getSunInfo(iSunInfo)->minute - lMinute) * lCompare > 0)
+    if (iWeekday == 7)
     {
-        lMinute = iTimer.getSunInfo(iSunInfo)->minute;
+        iWeekday = 0;
+        if (iHandleAsSunday)
+            return true;
     }
-    bool lResult = checkTimerTime(iTimer, iTimerIndex, iBitfield, lHour, lMinute, iSkipWeekday, iHandleAsSunday);
-    return lResult;
+    return iWeekday == iTimer.getWeekday();
 }
 
-
 // implementing timer startup, especially rerun of missed timers (called timer restore state)
 void LogicChannel::startTimerRestoreState()
 {
     // check if current logik channel is a timer channel
-    uint8_t lLogicFunction = (getByteParam(LOG_fDisable) & LOG_fDisableMask) ? 0 : getByteParam(LOG_fLogic);
+    uint8_t lLogicFunction = getParams().logic;
     if (lLogicFunction == VAL_Logic_Timer)
     {
         bool lShouldRestoreState = ((getByteParam(LOG_fTRestoreState) & LOG_fTRestoreStateMask) >> LOG_fTRestoreStateShift);
         if (lShouldRestoreState == 1) {
             // Timers with vacation handling cannot be restored
-            bool lIsUsingVacation = ((getByteParam(LOG_fTVacation) & LOG_fTVacationMask) >> LOG_fTVacationShift) <= VAL_Tim_Special_No;
-            if (lIsUsingVacation) {
-                pCurrentPipeline |= PIP_TIMER_RESTORE_STATE;
-                pCurrentPipeline &= ~PIP_TIMER_RESTORE_STEP; // ensure first processing step is set to 1
-            }
+            bool lIsUsingVacation = getTimerProgram().vacation <= VAL_Tim_Special_No;
+            if (lIsUsingVacation)
+                pCurrentPipeline() |= PIP_TIMER_RESTORE_STATE;
             printDebug("TimerRestore activated for channel %d\n", mChannelId + 1);
         }
     }
@@ -2244,194 +2478,36 @@ void LogicChannel::startTimerRestoreState()
 // remove timer restore flag
 void LogicChannel::stopTimerRestoreState()
 {
-    pCurrentPipeline &= ~(PIP_TIMER_RESTORE_STATE | PIP_TIMER_RESTORE_STEP);
-}
-
-// Restores the value for this timer, if the day fits
-void LogicChannel::processTimerRestoreState(TimerRestore &iTimer)
-{
-    bool lIsYearTimer = (getByteParam(LOG_fTYearDay) & LOG_fTYearDayMask);
-    uint8_t lCountTimer = lIsYearTimer ? 4 : 8; // there are 4 year timer or 8 day timer
-    bool lToday;                              // if it is a day timer lToday=true
-    int16_t lResult = -1;
-    bool lValue = false;
-    bool lEvaluate = false;
-
-    if (iTimer.isTimerValid() != tmValid) return;
-
-    // ensure, that this is just executed once per restore day
-    // we flag the execution according to the last bit of iteration counter
-    // as long as this is equal, the restore was already executed
-    bool lStepMarker = (pCurrentPipeline & PIP_TIMER_RESTORE_STEP);
-    bool lIterationIndicator = (iTimer.getDayIteration() & 1);
-    if (lStepMarker == lIterationIndicator)
-        return;
-
-    // toggle restore step bit to indicate, that this timer was checked for this day
-    pCurrentPipeline &= ~PIP_TIMER_RESTORE_STEP;
-    if (lIterationIndicator)
-        pCurrentPipeline |= PIP_TIMER_RESTORE_STEP;
-
-    int16_t lDayTime = iTimer.getHour() * 100 + iTimer.getMinute();
-
-    printDebug("Processing TimerRestore on Channel %d for Day %02d.%02d.%02d\n", mChannelId + 1, iTimer.getDay(), iTimer.getMonth(), iTimer.getYear());
-    // first we process settings valid for whole timer
-    // vacation is not processed (always skipped)
-
-    // holiday
-    uint8_t lHolidaySetting = (getByteParam(LOG_fTHoliday) & LOG_fTHolidayMask) >> LOG_fTHolidayShift;
-    if (lHolidaySetting == VAL_Tim_Special_No && (iTimer.holidayToday() >0))
-        lEvaluate = false;
-    if (lHolidaySetting == VAL_Tim_Special_Skip || lHolidaySetting == VAL_Tim_Special_Sunday)
-        lEvaluate = true;
-    if (lHolidaySetting == VAL_Tim_Special_Only)
-        lEvaluate = (iTimer.holidayToday() > 0);
-    if (!lEvaluate)
-        return;
-
-    bool lHandleAsSunday = (lHolidaySetting == VAL_Tim_Special_Sunday && (iTimer.holidayToday() >0));
-
-    // loop through all timer
-    uint32_t lTimerFunctions = getIntParam(LOG_fTd1DuskDawn);
-    for (uint8_t lTimerIndex = 0; lTimerIndex < lCountTimer; lTimerIndex++)
-    {
-        // get timer function code
-        uint8_t lTimerFunction = (lTimerFunctions >> (28 - lTimerIndex * 4)) & 0xF;
-        if (lTimerFunction)
-        {
-            // timer function is active
-            lToday = !lIsYearTimer || checkTimerToday(iTimer, lTimerIndex, lHandleAsSunday);
-            if (lToday)
-            {
-                uint16_t lBitfield = getWordParam(LOG_fTd1Value + 2 * lTimerIndex);
-                bool lCurrentValue = lBitfield & 0x8000;
-                int16_t lCurrentResult = -1;
-
-                // at this point we know, that this timer is valid for this day
-                // now we get the right swith time for that day
-                    
-                switch (lTimerFunction)
-                {
-                    case VAL_Tim_PointInTime:
-                        lCurrentResult = getPointInTime(iTimer, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday);
-                        if (lCurrentResult > -1)
-                            printDebug("TimerRestore: Found PointInTime %04d with value %d\n", lCurrentResult, lCurrentValue);
-                        break;
-                    case VAL_Tim_Sunrise_Plus:
-                        lCurrentResult = getSunAbs(iTimer, SUN_SUNRISE, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, false);
-                        if (lCurrentResult > -1)
-                            printDebug("TimerRestore: Found SunrisePlus %04d with value %d\n", lCurrentResult, lCurrentValue);
-                        break;
-                    case VAL_Tim_Sunrise_Minus:
-                        lCurrentResult = getSunAbs(iTimer, SUN_SUNRISE, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, true);
-                        if (lCurrentResult > -1)
-                            printDebug("TimerRestore: Found SunriseMinus %04d with value %d\n", lCurrentResult, lCurrentValue);
-                        break;
-                    case VAL_Tim_Sunset_Plus:
-                        lCurrentResult = getSunAbs(iTimer, SUN_SUNSET, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, false);
-                        if (lCurrentResult > -1)
-                            printDebug("TimerRestore: Found SunsetPlus %04d with value %d\n", lCurrentResult, lCurrentValue);
-                        break;
-                    case VAL_Tim_Sunset_Minus:
-                        lCurrentResult = getSunAbs(iTimer, SUN_SUNSET, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, true);
-                        if (lCurrentResult > -1)
-                            printDebug("TimerRestore: Found SunsetMinus %04d with value %d\n", lCurrentResult, lCurrentValue);
-                        break;
-                    case VAL_Tim_Sunrise_Earliest:
-                        lCurrentResult = getSunLimit(iTimer, SUN_SUNRISE, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, false);
-                        if (lCurrentResult > -1)
-                            printDebug("TimerRestore: Found SunriseEarliest %04d with value %d\n", lCurrentResult, lCurrentValue);
-                        break;
-                    case VAL_Tim_Sunrise_Latest:
-                        lCurrentResult = getSunLimit(iTimer, SUN_SUNRISE, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, true);
-                        if (lCurrentResult > -1)
-                            printDebug("TimerRestore: Found SunriseLatest %04d with value %d\n", lCurrentResult, lCurrentValue);
-                        break;
-                    case VAL_Tim_Sunset_Earliest:
-                        lCurrentResult = getSunLimit(iTimer, SUN_SUNSET, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, false);
-                        if (lCurrentResult > -1)
-                            printDebug("TimerRestore: Found SunsetEarliest %04d with value %d\n", lCurrentResult, lCurrentValue);
-                        break;
-                    case VAL_Tim_Sunset_Latest:
-                        lCurrentResult = getSunLimit(iTimer, SUN_SUNSET, lTimerIndex, lBitfield, lIsYearTimer, lHandleAsSunday, true);
-                        if (lCurrentResult > -1)
-                            printDebug("TimerRestore: Found SunsetLatest %04d with value %d\n", lCurrentResult, lCurrentValue);
-                        break;
-                    default:
-                        break;
-                }
-                // the time found in timer is taken, if
-                //   it is greater than the last found time
-                //   and smaller that the time of the processed day
-                // important: lDayTime is for today the current time, for any older day 2359 (End-Of-Day)
-                if (lCurrentResult > lResult && lCurrentResult <= lDayTime) {
-                    lResult = lCurrentResult;
-                    lValue = lCurrentValue;
-                }
-            }
-        }
-    }
-    if (lResult > -1)
-    {
-        printDebug("TimerRestore: Found timer %04d with value %d, starting processing\n", lResult, lValue);
-        startLogic(BIT_EXT_INPUT_2, lValue);
-        stopTimerRestoreState();
-    } else {
-        printDebug("TimerRestore: There are no timers for this day\n");
-    }
-}
-
-int16_t LogicChannel::getTimerTime(Timer &iTimer, uint8_t iTimerIndex, uint16_t iBitfield, uint8_t iHour, uint8_t iMinute, bool iSkipWeekday, bool iHandleAsSunday)
-{
-    int16_t lResult = -1;
-
-    // check correct timer index
-    if (iTimerIndex < 8)
-    {
-        if (iSkipWeekday || checkWeekday(iTimer, iBitfield & 0x7, iHandleAsSunday))
-        {
-            if (iHour == 31)
-                iHour = iTimer.getHour();
-            if (iMinute == 63)
-                iMinute = iTimer.getMinute();
-            lResult = iHour * 100 + iMinute;
-        }
-    }
-    return lResult;
+    pCurrentPipeline() &= ~PIP_TIMER_RESTORE_STATE;
 }
 
-int16_t LogicChannel::getPointInTime(Timer &iTimer, uint8_t iTimerIndex, uint16_t iBitfield, bool iSkipWeekday, bool iHandleAsSunday)
+// true, if restore still looks for the last switching time of this channel
+bool LogicChannel::isTimerRestorePending()
 {
-    uint8_t lHour = (iBitfield & 0x3E00) >> 9;
-    uint8_t lMinute = (iBitfield & 0x01F8) >> 3;
-    int16_t lResult = getTimerTime(iTimer, iTimerIndex, iBitfield, lHour, lMinute, iSkipWeekday, iHandleAsSunday);
-    return lResult;
+    return (pCurrentPipeline() & PIP_TIMER_RESTORE_STATE);
 }
 
-int16_t LogicChannel::getSunAbs(Timer &iTimer, uint8_t iSunInfo, uint8_t iTimerIndex, uint16_t iBitfield, bool iSkipWeekday, bool iHandleAsSunday, bool iMinus)
+// processes one day for timer restore, sun and holiday information is just calculated
+// for candidate days. Returns true, if restore for this channel is finished.
+bool LogicChannel::processTimerRestoreDay(TimerRestore &iTimer)
 {
-    int8_t lFactor = (iMinus) ? -1 : 1;
-    uint8_t lHour = (iTimer.getSunInfo(iSunInfo)->hour + ((iBitfield & 0x3E00) >> 9) * lFactor) % 24;
-    uint8_t lMinute = (iTimer.getSunInfo(iSunInfo)->minute + ((iBitfield & 0x01F8) >> 3) * lFactor) % 60;
-    int16_t lResult = getTimerTime(iTimer, iTimerIndex, iBitfield, lHour, lMinute, iSkipWeekday, iHandleAsSunday);
-    return lResult;
-}
-
-int16_t LogicChannel::getSunLimit(Timer &iTimer, uint8_t iSunInfo, uint8_t iTimerIndex, uint16_t iBitfield, bool iSkipWeekday, bool iHandleAsSunday, bool iLatest)
-{
-    uint8_t lHour = ((iBitfield & 0x3E00) >> 9);
-    uint8_t lMinute = ((iBitfield & 0x01F8) >> 3);
-    int8_t lCompare = iLatest ? -1 : 1; // else case means "Earliest"
-    if ((iTimer.getSunInfo(iSunInfo)->hour - lHour) * lCompare > 0)
-    {
-        lHour = iTimer.getSunInfo(iSunInfo)->hour;
-        lMinute = iTimer.getSunInfo(iSunInfo)->minute;
-    }
-    else if (iTimer.getSunInfo(iSunInfo)->hour == lHour && (iTimer.getSunInfo(iSunInfo)->minute - lMinute) * lCompare > 0)
-    {
-        lMinute = iTimer.getSunInfo(iSunInfo)->minute;
-    }
-    int16_t lResult = getTimerTime(iTimer, iTimerIndex, iBitfield, lHour, lMinute, iSkipWeekday, iHandleAsSunday);
-    return lResult;
+    sTimerProgram &lProgram = getTimerProgram();
+    bool lValue;
+    bool lHandleAsSunday;
+    if (lProgram.holiday != VAL_Tim_Special_Skip)
+        iTimer.prepareHolidays();
+    // vacation is not processed (always skipped)
+    if (!checkTimerDay(iTimer, false, lHandleAsSunday))
+        return false;
+    if (lProgram.needsSunInfo)
+        iTimer.prepareSunInfo();
+    // important: for today this is the current time, for any older day 23:59 (End-Of-Day)
+    uint16_t lDayMinute = iTimer.getHour() * 60 + iTimer.getMinute();
+    int16_t lMinute = evaluateTimerProgram(iTimer, lHandleAsSunday, lDayMinute, true, lValue);
+    if (lMinute < 0)
+        return false;
+    printDebug("TimerRestore: Channel %d found timer %02d:%02d on %02d.%02d.%02d with value %d\n", mChannelId + 1, lMinute / 60, lMinute % 60, iTimer.getDay(), iTimer.getMonth(), iTimer.getYear(), lValue);
+    startLogic(BIT_EXT_INPUT_2, lValue);
+    stopTimerRestoreState();
+    return true;
 }
-
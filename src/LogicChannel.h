@@ -6,16 +6,30 @@
 #include <Wire.h>
 #include "Timer.h"
 #include "TimerRestore.h"
+#include "TimingWheel.h"
 #include "KnxHelper.h"
-#include "EepromManager.h"
 #include "IncludeManager.h"
 #include "Hardware.h"
 
-#define SAVE_BUFFER_START_PAGE 0 // All stored KO data begin at this page and takes 40 pages,
+#define SAVE_BUFFER_START_PAGE 0 // All stored KO data begin at this page and takes 41 pages,
 #define SAVE_BUFFER_NUM_PAGES 41 // so next store should start at page 41
+// saved inputs are written alternating to 2 snapshot slots (page 1-20 and 21-40),
+// each slot starts with a header followed by the packed values of saved inputs.
+// If saved inputs do not fit into one of them, just slot A is used and spans page 1-40
+#define SAVE_SLOT_PAGES 20
+#define SAVE_SLOT_ADDRESS(slot) ((SAVE_BUFFER_START_PAGE + 1 + (slot) * SAVE_SLOT_PAGES) * 32)
+#define SAVE_SLOT_HEADER_SIZE 16
+#define SAVE_SLOT_DATA_SIZE (SAVE_SLOT_PAGES * 32 - SAVE_SLOT_HEADER_SIZE) // 624 bytes
+#define SAVE_SINGLE_SLOT_DATA_SIZE (2 * SAVE_SLOT_PAGES * 32 - SAVE_SLOT_HEADER_SIZE) // 1264 bytes
 
 // here we define, how many channels are compiled into firmware, has to be greater equal the number in knxprod
 #define LOG_ChannelsFirmware COUNT_LOG_CHANNEL
+// value memory is written in 16 byte blocks, each input has at most 4 bytes
+#if LOG_ChannelsFirmware * 2 * 4 > SAVE_SINGLE_SLOT_DATA_SIZE
+#define SAVE_VALUE_BLOCKS (SAVE_SINGLE_SLOT_DATA_SIZE / 16)
+#else
+#define SAVE_VALUE_BLOCKS ((LOG_ChannelsFirmware * 2 * 4 + 15) / 16)
+#endif
 
 // enum input defaults
 #define VAL_InputDefault_Undefined 0
@@ -104,24 +118,41 @@
 #define IO_Output 3
 
 // pipeline steps
-#define PIP_STARTUP 1                     // startup delay for each channel
-#define PIP_REPEAT_INPUT1 2               // send read requests for input 1
-#define PIP_REPEAT_INPUT2 4               // send read requests for input 2
-#define PIP_CONVERT_INPUT1 8              // convert input value 1 to bool
-#define PIP_CONVERT_INPUT2 16             // convert input value 2 to bool
-#define PIP_LOGIC_EXECUTE 32              // do logical step
+// stages of a running channel are processed in order of their bits (see LogicChannel::loop()),
+// this order is the reverse order of the pipeline
+#define PIP_ON_REPEAT 1                   // repeat on signal
+#define PIP_OFF_REPEAT 2                  // repeat off signal
+#define PIP_OUTPUT_FILTER_ON 4            // Filter repeated signals
+#define PIP_OUTPUT_FILTER_OFF 8           // Filter repeated signals
+#define PIP_OFF_DELAY 16                  // delay off signal
+#define PIP_ON_DELAY 32                   // delay on signal
 #define PIP_STAIRLIGHT 64                 // do stairlight delay
-#define PIP_BLINK 128                     // do blinking during stairlight
-#define PIP_ON_DELAY 256                  // delay on signal
-#define PIP_OFF_DELAY 512                 // delay off signal
-#define PIP_OUTPUT_FILTER_ON 1024         // Filter repeated signals
-#define PIP_OUTPUT_FILTER_OFF 2048        // Filter repeated signals
-#define PIP_ON_REPEAT 4096                // repeat on signal
-#define PIP_OFF_REPEAT 8192               // repeat off signal
-#define PIP_TIMER_INPUT 16384             // process timer as input signal
+#define PIP_BLINK 128                     // do blinking during stairlight (has to be "after" stairlight)
+#define PIP_LOGIC_EXECUTE 256             // do logical step
+#define PIP_CONVERT_INPUT1 512            // convert input value 1 to bool
+#define PIP_CONVERT_INPUT2 1024           // convert input value 2 to bool
+#define PIP_REPEAT_INPUT1 2048            // send read requests for input 1
+#define PIP_REPEAT_INPUT2 4096            // send read requests for input 2
+#define PIP_TIMER_INPUT 8192              // process timer as input signal
+#define PIP_STAGE_COUNT 14                // number of stages above
+#define PIP_STAGE_MASK 16383              // all stages above
+#define PIP_STARTUP 16384                 // startup delay for each channel
 #define PIP_RUNNING 32768                 // is a currently running channel
 #define PIP_TIMER_RESTORE_STATE 65536     // timer restore is active for this channel
-#define PIP_TIMER_RESTORE_STEP 131072     // timer restore for this channel was processed an other day back
+
+// delays of a channel, each one is a timer in timing wheel
+#define DLY_ON_DELAY 0                    // delay on signal
+#define DLY_STARTUP DLY_ON_DELAY          // startup delay, shared with on delay, which starts not before channel is running
+#define DLY_OFF_DELAY 1                   // delay off signal
+#define DLY_STAIRLIGHT 2                  // stairlight time
+#define DLY_BLINK 3                       // blink time during stairlight
+#define DLY_ON_OFF_REPEAT 4               // repeat on or off signal
+#define DLY_REPEAT_INPUT1 5               // repeat read request for input 1
+#define DLY_REPEAT_INPUT2 6               // repeat read request for input 2
+#define DLY_COUNT 7                       // number of delays per channel
+
+// pipeline steps, which are just processed after their delay expired
+#define PIP_WAIT_FOR_DELAY (PIP_STARTUP | PIP_REPEAT_INPUT1 | PIP_REPEAT_INPUT2 | PIP_STAIRLIGHT | PIP_BLINK | PIP_ON_DELAY | PIP_OFF_DELAY | PIP_ON_REPEAT | PIP_OFF_REPEAT)
 
 #define TIMD_WEEKDAY_MASK 0x0007
 #define TIMD_WEEKDAY_SHIFT 0
@@ -183,6 +214,8 @@
 #define VAL_Tim_Every_Month 0
 #define VAL_Tim_Last_Day 32
 
+#define VAL_Tim_NoSwitchToday 1440 // minute of day, if a timer channel does not switch anymore today
+
 #define VAL_Tim_YearTimerCount 4
 #define VAL_Tim_DayTimerCount 8
 
@@ -192,12 +225,103 @@ const uint32_t cTimeFactors[] = {100, 1000, 60000, 3600000};
 
 class Logic;
 
+// runtime information of all channels as structure of arrays, each array has
+// one entry per channel and is indexed by channel id. Memory is provided by logic.
+struct sChannelState
+{
+    uint32_t *currentPipeline; // Bitfield: indicator for current pipeline step
+    uint8_t *triggerIO;        // Bitfield: Which input (0-3) triggered processing, Bit 4-7 are not used
+    uint8_t *validActiveIO;    // Bitfield: validity flags for input (0-3) values and active inputs (4-7)
+    uint8_t *currentIn;        // Bitfield: current input (0-3), free (4), first processing (5), previous gate (6) and free (7) values
+    uint8_t *currentOut;       // Bitfield: logic output (0), blink output (1), previous output (2)
+    uint8_t *currentIODebug;   // Bitfield: current input (0-3), logic output (4)
+    uint8_t *expiredDelays;    // Bitfield: delays (DLY_*), which expired and wait for processing
+};
+#define LOG_StateBytesPerChannel (sizeof(uint32_t) + 6 * sizeof(uint8_t))
+
+// one timer of a timer channel, decoded from LOG_fTd*/LOG_fTy* parameters
+struct sTimerEntry
+{
+    uint8_t function;   // VAL_Tim_*, inactive timers are not part of a timer program
+    uint8_t hour;       // hour or offset to sunrise/sunset, VAL_Tim_Every_Hour
+    uint8_t minute;     // minute or offset to sunrise/sunset, VAL_Tim_Every_Minute
+    uint8_t weekday;    // day timer: 1=Monday, ..., 7=Sunday, 0=any
+    uint8_t month;      // year timer: 1-12, 0=every month
+    uint8_t dayWeekday; // year timer: byte LOG_fTy1Day, day or weekday bitfield (bit 0 set)
+    bool value;
+};
+
+// timers of a timer channel, compiled once from parameter memory and
+// evaluated by timer processing and timer restore
+struct sTimerProgram
+{
+    uint8_t count;     // number of active timers in entry
+    bool isYearTimer;
+    bool needsSunInfo; // at least one timer depends on sunrise or sunset
+    uint8_t vacation;  // vacation handling (VAL_Tim_Special_*)
+    uint8_t holiday;   // holiday handling (VAL_Tim_Special_*)
+    uint8_t weekdays;  // bit n is set, if a timer may switch on weekday n (0 = sunday)
+    sTimerEntry entry[VAL_Tim_DayTimerCount];
+};
+
+// converter parameters of an input, decoded once and scaled like the input value
+union uConvertParams
+{
+    struct
+    {
+        int32_t low;        // lower bound of interval or hysteresis (also delta), single value or constant
+        int32_t high;       // upper bound of interval or hysteresis (also delta)
+    } bound;
+    uint64_t valueMask;     // DPT2 and DPT17: bit n is set, if value n is accepted
+    uint8_t byteValues[8];  // single values of DPT5, DPT5001 and DPT6
+    uint16_t wordValues[4]; // single values of DPT7 and DPT8
+};
+
+// parameters used in pipeline processing, decoded once from parameter memory.
+// Times are converted to ms, bitfield bytes are kept and evaluated by their masks.
+struct sChannelParams
+{
+    uint32_t inputRepeat[2];  // read repeat time of input 1 and 2
+    uint32_t stairlightTime;
+    uint32_t blinkTime;
+    uint32_t onDelay;
+    uint32_t offDelay;
+    uint32_t onRepeat;
+    uint32_t offRepeat;
+    uConvertParams convert[2]; // converter of input 1 and 2
+    uint8_t logic;            // logical function, 0 if channel is disabled
+    uint8_t calculate;        // byte LOG_fCalculate, also contains disable and alarm
+    uint8_t triggerInputs;    // inputs of LOG_fTrigger, which trigger output on each telegram
+    uint8_t triggerFirstProcessing; // first processing handling of LOG_fTrigger
+    uint8_t gateTriggerClose; // byte LOG_fTriggerGateClose
+    uint8_t gateTriggerOpen;  // byte LOG_fTriggerGateOpen
+    uint8_t input[2];         // byte LOG_fE1/LOG_fE2, input mode and converter
+    uint8_t inputDpt[2];
+    uint8_t inputDefault[2];  // byte LOG_fE1Default/LOG_fE2Default, also contains repeat flag
+    uint8_t internalInput;    // byte LOG_fI1/LOG_fI2
+    uint8_t delay;            // byte LOG_fODelay, repeat and reset handling of delays
+    uint8_t stairlight;       // byte LOG_fOStair, also contains retrigger, off and output filter
+    uint8_t outputDpt;
+    uint8_t onOutput;         // byte LOG_fOOn
+    uint8_t offOutput;        // byte LOG_fOOff
+};
+
 class LogicChannel
 {
   private:
+    typedef void (LogicChannel::*PipelineStage)();
+    static const PipelineStage cPipelineStages[PIP_STAGE_COUNT];
+    typedef bool (LogicChannel::*LogicKernel)(uint8_t iValidInputs, uint8_t iActiveInputs, uint8_t iCurrentInputs, bool &cValidOutput);
+    static const LogicKernel cLogicKernels[VAL_Logic_Timer + 1];
+
     // instance
     uint8_t mChannelId;
+    sChannelParams mParams;
+    bool mParamsValid;
+    sTimerProgram *mTimerProgram; // just allocated for timer channels
+    LogicKernel mLogicKernel;
 #if LOGIC_TRACE
+    static const char *cLogicNames[VAL_Logic_Timer + 1];
     static char sFilter[30];
     int channelDebug(const char *format, ...);
     bool debugFilter();
@@ -212,6 +336,9 @@ class LogicChannel
     int32_t getSIntParam(uint16_t iParamIndex);
     float getFloatParam(uint16_t iParamIndex);
     uint8_t* getStringParam(uint16_t iParamIndex);
+    void decodeParams();
+    void decodeConvertParams(uint8_t iIOIndex);
+    sChannelParams &getParams();
     GroupObject *getKo(uint8_t iIOIndex);
     Dpt &getKoDPT(uint8_t iIOIndex);
     void knxWriteBool(uint8_t iIOIndex, bool iValue);
@@ -232,6 +359,11 @@ class LogicChannel
     void setBuzzer(uint16_t iParamIndex);
     
     bool isInputActive(uint8_t iIOIndex);
+    void startPipeline(uint32_t iPipelineSteps);
+    void startDelay(uint8_t iDelay, uint32_t iDuration);
+    void stopDelay(uint8_t iDelay);
+    uint32_t getDelayRemaining(uint8_t iDelay);
+    bool checkDelayExpired(uint8_t iDelay);
 
     void startStartup();
     void processStartup();
@@ -239,10 +371,17 @@ class LogicChannel
     void processRepeatInput2();
     void stopRepeatInput(uint8_t iIOIndex);
     void startConvert(uint8_t iIOIndex);
-    bool checkConvertValues(uint16_t iParamValues, uint8_t iValueSize, int32_t iValue);
+    bool checkConvertValues(uint8_t iIOIndex, int32_t iValue);
     void processConvertInput(uint8_t iIOIndex);
+    void processConvertInput1();
+    void processConvertInput2();
     void startLogic(uint8_t iIOIndex, bool iValue);
+    void bindLogicKernel();
+    bool logicInvalid(uint8_t iValidInputs, uint8_t iActiveInputs, uint8_t iCurrentInputs, bool &cValidOutput);
+    bool logicGate(uint8_t iValidInputs, uint8_t iActiveInputs, uint8_t iCurrentInputs, bool &cValidOutput);
+    bool logicTimer(uint8_t iValidInputs, uint8_t iActiveInputs, uint8_t iCurrentInputs, bool &cValidOutput);
     void processLogic();
+    bool isBatchLogic();
     void startStairlight(bool iOutput);
     void processStairlight();
     void startBlink();
@@ -261,57 +400,33 @@ class LogicChannel
     bool readOneInputFromEEPROM(uint8_t iIOIndex);
 
     // Start of Timer implementation
+    void compileTimerProgram();
+    sTimerProgram &getTimerProgram();
     void processTimerInput();
-    bool checkTimerToday(Timer &iTimer, uint8_t iTimerIndex, bool iHandleAsSunday);
+    bool checkTimerDay(Timer &iTimer, bool iIsVacation, bool &cHandleAsSunday);
+    int16_t evaluateTimerProgram(Timer &iTimer, bool iHandleAsSunday, uint16_t iMinute, bool iLatest, bool &cValue);
+    bool getTimerEntryTime(Timer &iTimer, sTimerEntry &iEntry, bool iHandleAsSunday, uint8_t &cHour, uint8_t &cMinute);
+    int16_t findTimerMinute(uint8_t iHour, uint8_t iMinute, uint16_t iMinuteOfDay, bool iLatest);
+    bool checkTimerToday(Timer &iTimer, sTimerEntry &iEntry, bool iHandleAsSunday);
     bool checkWeekday(Timer &iTimer, uint8_t iWeekday, bool iHandleAsSunday);
-    bool checkTimerTime(Timer &iTimer, uint8_t iTimerIndex, uint16_t iBitfield, uint8_t iHour, uint8_t iMinute, bool iSkipWeekday, bool iHandleAsSunday);
-    bool checkPointInTime(Timer &iTimer, uint8_t iTimerIndex, uint16_t iBitfield, bool iSkipWeekday, bool iHandleAsSunday);
-    bool checkSunAbs(Timer &iTimer, uint8_t iSunInfo, uint8_t iTimerIndex, uint16_t iBitfield, bool iSkipWeekday, bool iHandleAsSunday, bool iMinus);
-    bool checkSunLimit(Timer &iTimer, uint8_t iSunInfo, uint8_t iTimerIndex, uint16_t iBitfield, bool iSkipWeekday, bool iHandleAsSunday, bool iLatest);
-    int16_t getTimerTime(Timer &iTimer, uint8_t iTimerIndex, uint16_t iBitfield, uint8_t iHour, uint8_t iMinute, bool iSkipWeekday, bool iHandleAsSunday);
-    int16_t getPointInTime(Timer &iTimer, uint8_t iTimerIndex, uint16_t iBitfield, bool iSkipWeekday, bool iHandleAsSunday);
-    int16_t getSunAbs(Timer &iTimer, uint8_t iSunInfo, uint8_t iTimerIndex, uint16_t iBitfield, bool iSkipWeekday, bool iHandleAsSunday, bool iMinus);
-    int16_t getSunLimit(Timer &iTimer, uint8_t iSunInfo, uint8_t iTimerIndex, uint16_t iBitfield, bool iSkipWeekday, bool iHandleAsSunday, bool iLatest);
-    uint32_t getTimerNow(bool iMidnight);
-    void processTimerRestoreState(TimerRestore &iTimer);
 
   protected:
 
-    union uInputProcessing
-    {
-        struct
-        {
-            uint32_t repeatInput1Delay;
-            uint32_t repeatInput2Delay;
-        };
-        struct
-        {
-            uint8_t activeTimer;
-            uint8_t processedTimer;
-        };
-    };
-
     // static
     static Timer &sTimer;
     static TimerRestore &sTimerRestore;
+    static TimingWheel &sTimingWheel;
+    static const uint32_t cDelayPipeline[DLY_COUNT];
 
     // instance
-    /* Runtime information per channel */
-    uint8_t pTriggerIO;        // Bitfield: Which input (0-3) triggered processing, Bit 4-7 are not used
-    uint8_t pValidActiveIO;    // Bitfield: validity flags for input (0-3) values and active inputs (4-7)
-    uint8_t pCurrentIn;        // Bitfield: current input (0-3), free (4), first processing (5), previous gate (6) and free (7) values
-    uint8_t pCurrentOut;       // Bitfield: logic output (0), blink output (1), previous output (2)
-    uint32_t pCurrentPipeline; // Bitfield: indicator for current pipeline step
-
-    uint8_t pCurrentIODebug;   // Bitfield: current input (0-3), logic output (4)
-    // uint32_t pRepeatInput1Delay;  // used also for timer preparation
-    // uint32_t pRepeatInput2Delay;  // used also for timer processing
-    uInputProcessing pInputProcessing;
-    uint32_t pStairlightDelay;
-    uint32_t pBlinkDelay;
-    uint32_t pOnDelay;
-    uint32_t pOffDelay;
-    uint32_t pRepeatOnOffDelay;
+    /* Runtime information of this channel, stored in state arrays of logic */
+    uint8_t &pTriggerIO() { return sState->triggerIO[mChannelId]; }
+    uint8_t &pValidActiveIO() { return sState->validActiveIO[mChannelId]; }
+    uint8_t &pCurrentIn() { return sState->currentIn[mChannelId]; }
+    uint8_t &pCurrentOut() { return sState->currentOut[mChannelId]; }
+    uint32_t &pCurrentPipeline() { return sState->currentPipeline[mChannelId]; }
+    uint8_t &pCurrentIODebug() { return sState->currentIODebug[mChannelId]; }
+    uint8_t &pExpiredDelays() { return sState->expiredDelays[mChannelId]; }
 
   public:
     // Constructors
@@ -320,6 +435,7 @@ class LogicChannel
 
     // static
     static Logic *sLogic;
+    static sChannelState *sState;
     static uint16_t calcKoNumber(uint8_t iIOIndex, uint8_t iChannelId);
     static GroupObject *getKoForChannel(uint8_t iIOIndex, uint8_t iChannelId);
     static float getFloat(uint8_t *data);
@@ -327,13 +443,25 @@ class LogicChannel
     // instance
     bool checkDpt(uint8_t iIOIndex, uint8_t iDpt);
     void processInput(uint8_t iIOIndex);
-    void processInternalInputs(uint8_t iChannelId, bool iValue);
+    uint8_t getChannelId();
+    bool isRunning();
+    void finishLogic(bool iEvaluated, bool iValidOutput, bool iNewOutput);
+    uint8_t getInternalInputSource(uint8_t iIOIndex);
+    void processInternalInput(uint8_t iIOIndex, bool iValue);
     bool processDiagnoseCommand(char* cBuffer);
     void startTimerInput();
+    bool isTimerChannel();
+    bool isInputSavedInEEPROM(uint8_t iIOIndex);
+    uint16_t getNextTimerMinute(uint16_t iFromMinute);
     void startTimerRestoreState();
     void stopTimerRestoreState();
-    void writeSingleDptToEEPROM(uint8_t iIOIndex);
+    bool isTimerRestorePending();
+    bool processTimerRestoreDay(TimerRestore &iTimer);
+    void processDelayExpired(uint8_t iDelay);
+    uint8_t getSaveLayout(uint8_t iIOIndex, uint8_t &cDpt);
 
+    void invalidateParams();
     bool prepareChannel();
+    bool hasPendingWork();
     void loop();
 };
\ No newline at end of file
@@ -46,8 +46,12 @@ bool startupDelay()
 
 void appLoop()
 {
+    // during ETS programming logic just finishes a pending save
     if (!knx.configured())
+    {
+        gLogic.loop();
         return;
+    }
 
     // handle KNX stuff
     if (startupDelay())
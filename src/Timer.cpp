@@ -5,6 +5,15 @@
 
 sDay Timer::cHolidays[29] = {{1, 1}, {6, 1}, {-52, EASTER}, {-48, EASTER}, {-47, EASTER}, {-46, EASTER}, {-3, EASTER}, {-2, EASTER}, {0, EASTER}, {1, EASTER}, {1, 5}, {39, EASTER}, {49, EASTER}, {50, EASTER}, {60, EASTER}, {8, 8}, {15, 8}, {3, 10}, {31, 10}, {1, 11}, {-32, ADVENT}, {-21, ADVENT}, {-14, ADVENT}, {-7, ADVENT}, {0, ADVENT}, {24, 12}, {25, 12}, {26, 12}, {31, 12}};
 
+int16_t Timer::sSunTable[366][2];
+uint16_t Timer::sSunTableYear = 0;
+float Timer::sSunTableLongitude = 0;
+float Timer::sSunTableLatitude = 0;
+int8_t Timer::sSunTableTimezone = 0;
+
+uint8_t Timer::sHolidayTable[366] = {0};
+int16_t Timer::sHolidayTableYear = -1;
+
 Timer::Timer()
 {
     mNow.tm_year = 120;
@@ -40,56 +49,217 @@ void Timer::setup(double iLongitude, double iLatitude, int8_t iTimezone, bool iU
     }
 }
 
+bool Timer::isLeapYear(uint16_t iYear) {
+    return (iYear % 4 == 0 && iYear % 100 != 0) || iYear % 400 == 0;
+}
+
+// iMonth is 1 based
+uint8_t Timer::getDaysInMonth(uint16_t iYear, uint8_t iMonth) {
+    static const uint8_t cDaysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (iMonth == 2 && isLeapYear(iYear)) ? 29 : cDaysInMonth[iMonth - 1];
+}
+
+// calendar clock, rolls over all fields of mNow without mktime
+eTimeChange Timer::advanceSecond() {
+    if (++mNow.tm_sec < 60)
+        return tcSecond;
+    mNow.tm_sec = 0;
+    if (++mNow.tm_min < 60)
+        return tcMinute;
+    mNow.tm_min = 0;
+    if (++mNow.tm_hour < 24)
+        return tcMinute;
+    mNow.tm_hour = 0;
+    mNow.tm_wday = (mNow.tm_wday + 1) % 7;
+    mNow.tm_yday += 1;
+    if (++mNow.tm_mday <= getDaysInMonth(getYear(), getMonth()))
+        return tcDay;
+    mNow.tm_mday = 1;
+    if (++mNow.tm_mon < 12)
+        return tcDay;
+    mNow.tm_mon = 0;
+    mNow.tm_yday = 0;
+    mNow.tm_year += 1;
+    return tcYear;
+}
+
 void Timer::loop() {
-    if (delayCheck(mTimeDelay, 1000))
+    if (delayCheck(mTimeDelay, mSecondMillis))
     {
-        mTimeDelay = millis();
-        mNow.tm_sec += 1;
-        mktime(&mNow);
-        if (mTimeValid == tmValid)
+        // next second starts relative to the last one, so loop latency does not add up
+        mTimeDelay += mSecondMillis;
+        mDriftAccu += mDriftPpm;
+        mSecondMillis = 1000 + mDriftAccu / 1000;
+        mDriftAccu %= 1000;
+        processClockStep();
+    }
+}
+
+// one second of local clock including all date dependent calculations.
+// Besides loop() this can be called by a simulation, which drives the clock
+// independent of millis(), e.g. to run through a whole year on host
+void Timer::processClockStep() {
+    eTimeChange lChange = advanceSecond();
+    if (mTimeValid == tmValid)
+    {
+        if (mPendingChange > lChange)
+            lChange = mPendingChange;
+        mPendingChange = tcSecond;
+        if (lChange >= tcMinute)
         {
-            if (mMinuteTick != mNow.tm_min)
-            {
-                mMinuteChanged = true;
-                // just call once a minute
-                mMinuteTick = mNow.tm_min;
-                if (mUseSummertime && (getMonth() == 3 || getMonth() == 10) && getHour() == 3 && getMinute() == 1)
-                    calculateSummertime();
-            }
-            if (mYearTick != mNow.tm_year)
-            {
-                calculateEaster();
-                calculateAdvent();
-                calculateSummertime(); // initial summertime calculation if year changes
-                calculateHolidays();
-                mYearTick = mNow.tm_year;
-            }
-            // important: Day calculations AFTER year calculations
-            if (mDayTick != mNow.tm_mday)
-            {
-                calculateSunriseSunset();
-                if (!mHolidayChanged)
-                    calculateHolidays();
-                mDayTick = mNow.tm_mday;
-            }
+            mMinuteChanged = true;
         }
+        processDateChange(lChange);
     }
 }
 
+// date dependent calculations for a new day or year
+void Timer::processDateChange(eTimeChange iChange)
+{
+    if (iChange == tcYear)
+    {
+        calculateEaster();
+        calculateAdvent();
+        calculateHolidayTable();
+        calculateSummertime(); // summertime instants are calculated once a year
+        calculateHolidays();
+    }
+    // important: Day calculations AFTER year calculations
+    if (iChange >= tcDay)
+    {
+        calculateSunriseSunset();
+        if (!mHolidayChanged)
+            calculateHolidays();
+        mDayChanged = true;
+    }
+}
+
+// date changes by bus telegrams are calculated as soon as date and time are valid,
+// so nobody sees the new date with holidays and sun of the previous one
+void Timer::processPendingChange()
+{
+    if (mTimeValid != tmValid)
+        return;
+    processDateChange(mPendingChange);
+    mPendingChange = tcSecond;
+}
+
+// returns sun table entry of current day, the table is reset if year or location changed.
+// Timer and TimerRestore share the table, so days are calculated at most once per year
+int16_t *Timer::getSunTableEntry()
+{
+    if (sSunTableYear != getYear() || sSunTableLongitude != mLongitude || sSunTableLatitude != mLatitude || sSunTableTimezone != mTimezone)
+    {
+        for (uint16_t lDay = 0; lDay < 366; lDay++)
+        {
+            sSunTable[lDay][SUN_SUNRISE] = SUN_UNKNOWN;
+            sSunTable[lDay][SUN_SUNSET] = SUN_UNKNOWN;
+        }
+        sSunTableYear = getYear();
+        sSunTableLongitude = mLongitude;
+        sSunTableLatitude = mLatitude;
+        sSunTableTimezone = mTimezone;
+    }
+    int16_t *lEntry = sSunTable[mNow.tm_yday];
+    if (lEntry[SUN_SUNRISE] == SUN_UNKNOWN)
+    {
+        sunfloat_t rise, set;
+        // sunrise/sunset calculation
+        sunRiseSet(getYear(), getMonth(), getDay(),
+                   mLongitude, mLatitude, SUN_F(35.0 / 60.0), 1, &rise, &set);
+        // timezone offset or polar edge cases might shift a result to previous or next day
+        lEntry[SUN_SUNRISE] = normalizeMinuteOfDay((int16_t)SUN_ROUND(rise * SUN_F(60.0)) + mTimezone * 60);
+        lEntry[SUN_SUNSET] = normalizeMinuteOfDay((int16_t)SUN_ROUND(set * SUN_F(60.0)) + mTimezone * 60);
+    }
+    return lEntry;
+}
+
+// brings a minute into range of one day (0..1439)
+int16_t Timer::normalizeMinuteOfDay(int16_t iMinute)
+{
+    return (iMinute % 1440 + 1440) % 1440;
+}
+
 void Timer::calculateSunriseSunset()
 {
-    double rise, set;
-    // sunrise/sunset calculation
-    sunRiseSet(getYear(), getMonth(), getDay(),
-               mLongitude, mLatitude, 35.0 / 60.0, 1, &rise, &set);
-    double lTmp;
-    mSunrise.minute = round(modf(rise, &lTmp) * 60.0);
-    mSunrise.hour = lTmp + mTimezone + ((mIsSummertime) ? 1 : 0);
-    mSunset.minute = round(modf(set, &lTmp) * 60.0);
-    mSunset.hour = lTmp + mTimezone + ((mIsSummertime) ? 1 : 0);
+    int16_t *lEntry = getSunTableEntry();
+    int16_t lSunrise = normalizeMinuteOfDay(lEntry[SUN_SUNRISE] + (isSummertime(lEntry[SUN_SUNRISE]) ? 60 : 0));
+    int16_t lSunset = normalizeMinuteOfDay(lEntry[SUN_SUNSET] + (isSummertime(lEntry[SUN_SUNSET]) ? 60 : 0));
+    mSunrise.minute = lSunrise % 60;
+    mSunrise.hour = lSunrise / 60;
+    mSunset.minute = lSunset % 60;
+    mSunset.hour = lSunset / 60;
+}
+
+// measures the offset between local clock and a time telegram and estimates the drift of
+// the local clock. Returns false, if local clock is still exact enough and should not be set.
+bool Timer::disciplineClock(tm *iTime) {
+    uint32_t lNow = millis();
+    bool lSynced = (mLastSyncMillis != 0 && (mTimeValid & tmMinutesValid));
+    mLastSyncMillis = lNow;
+    if (mLastSyncMillis == 0)
+        mLastSyncMillis = 1; // 0 means never synced
+    if (!lSynced)
+    {
+        mDriftAnchorMillis = lNow;
+        mDriftStepAccu = 0;
+        return true;
+    }
+    // offset of local clock against bus time, positive if local clock is ahead
+    int32_t lOffset = ((getHour() * 60L + getMinute()) * 60L + getSecond()) - ((iTime->tm_hour * 60L + iTime->tm_min) * 60L + iTime->tm_sec);
+    lOffset = lOffset * 1000 + (int32_t)(lNow - mTimeDelay);
+    if (lOffset > 43200000L)
+        lOffset -= 86400000L;
+    else if (lOffset < -43200000L)
+        lOffset += 86400000L;
+    if (lOffset <= -TIMER_STEP_LIMIT_MS || lOffset >= TIMER_STEP_LIMIT_MS)
+    {
+        // a new time, not drift, measurement starts again
+        mDriftAnchorMillis = lNow;
+        mDriftStepAccu = 0;
+        return true;
+    }
+    bool lStep = (lOffset <= -1000 || lOffset >= 1000); // beyond resolution of time telegram
+    // offset since anchor includes all steps done in between, so drift is also measured,
+    // if the clock has to be stepped more often than TIMER_DRIFT_MIN_INTERVAL
+    int32_t lTotalOffset = mDriftStepAccu + lOffset;
+    uint32_t lElapsed = lNow - mDriftAnchorMillis;
+    if (lElapsed >= TIMER_DRIFT_MIN_INTERVAL && (lTotalOffset <= -1000 || lTotalOffset >= 1000))
+    {
+        // remaining drift is corrected damped, telegram resolution limits accuracy
+        int32_t lResidualPpm = (int64_t)lTotalOffset * 1000000 / lElapsed;
+        mDriftPpm += lResidualPpm / 2;
+        if (mDriftPpm > TIMER_MAX_DRIFT_PPM)
+            mDriftPpm = TIMER_MAX_DRIFT_PPM;
+        if (mDriftPpm < -TIMER_MAX_DRIFT_PPM)
+            mDriftPpm = -TIMER_MAX_DRIFT_PPM;
+        mDriftUncertaintyPpm = (uint64_t)2000 * 1000000 / lElapsed + 2;
+        printDebug("Timer: offset %ld ms after %lu s, drift now %ld ppm\n", lTotalOffset, lElapsed / 1000, mDriftPpm);
+        // next measurement starts here, an offset not corrected by a step belongs to it
+        mDriftAnchorMillis = lNow;
+        mDriftStepAccu = lStep ? 0 : -lOffset;
+    }
+    else if (lStep)
+    {
+        mDriftStepAccu += lOffset;
+    }
+    return lStep;
+}
+
+// estimated error of local clock in ms since last time telegram
+uint32_t Timer::getEstimatedError() {
+    if (mLastSyncMillis == 0)
+        return 0xFFFFFFFF;
+    return 1000 + (uint64_t)(millis() - mLastSyncMillis) * mDriftUncertaintyPpm / 1000000;
+}
+
+bool Timer::needsTimeSync() {
+    return getEstimatedError() > TIMER_MAX_ERROR_MS;
 }
 
 void Timer::setTimeFromBus(tm *iTime) {
+    if (!disciplineClock(iTime))
+        return;
     if (mNow.tm_min != iTime->tm_min || mNow.tm_hour != iTime->tm_hour)
         mMinuteChanged = true;
     mNow.tm_sec = iTime->tm_sec;
@@ -97,7 +267,10 @@ void Timer::setTimeFromBus(tm *iTime) {
     mNow.tm_hour = iTime->tm_hour;
     mktime(&mNow);
     mTimeDelay = millis();
+    mDriftAccu = 0;
+    mSecondMillis = 1000;
     mTimeValid = static_cast<eTimeValid>(mTimeValid | tmMinutesValid);
+    processPendingChange();
 }
 
 void Timer::setDateFromBus(tm *iDate) {
@@ -105,21 +278,21 @@ void Timer::setDateFromBus(tm *iDate) {
     // in case of date changes
     if (iDate->tm_year != getYear())
     {
-        mYearTick = -1; // triggers easter calculation
-        mDayTick = -1;    // triggers sunrise/sunset calculation
+        mPendingChange = tcYear; // triggers easter and sunrise/sunset calculation
         mMinuteChanged = true;
     }
     else if (iDate->tm_mon != getMonth() || iDate->tm_mday != getDay())
     {
-        mDayTick = -1; // triggers sunrise/sunset calculation
+        if (mPendingChange < tcDay)
+            mPendingChange = tcDay; // triggers sunrise/sunset calculation
         mMinuteChanged = true;
     }
     mNow.tm_mday = iDate->tm_mday;
     mNow.tm_mon = iDate->tm_mon - 1;
     mNow.tm_year = iDate->tm_year - 1900;
     mktime(&mNow);
-    mTimeDelay = millis();
     mTimeValid = static_cast<eTimeValid>(mTimeValid | tmDateValid);
+    processPendingChange();
 }
 
 bool Timer::minuteChanged() {
@@ -199,57 +372,43 @@ void Timer::clearHolidayChanged() {
     mHolidayChanged = false;
 }
 
+bool Timer::dayChanged() {
+    return mDayChanged;
+}
+
+void Timer::clearDayChanged() {
+    mDayChanged = false;
+}
+
 eTimeValid Timer::isTimerValid() {
     return mTimeValid;
 }
 
-uint8_t Timer::calculateLastSundayInMonth(uint8_t iMonth) {
-    mTimeHelper.tm_year = mNow.tm_year;
-    mTimeHelper.tm_mon = iMonth - 1;
-    mTimeHelper.tm_mday = 31;
-    mktime(&mTimeHelper);
-    return mTimeHelper.tm_mday - mTimeHelper.tm_wday;
+// day of year of the last sunday in iMonth, derived from the weekday of current day
+uint16_t Timer::getLastSundayInMonth(uint8_t iMonth) {
+    uint16_t lDayOfYear = getDayOfYear(getDaysInMonth(getYear(), iMonth), iMonth);
+    uint8_t lWeekday = (mNow.tm_wday + lDayOfYear + 7 * 53 - mNow.tm_yday) % 7;
+    return lDayOfYear - lWeekday;
 }
 
-// should be called only at 03:01 o'clock
+// summertime starts on last sunday in march at 2:00 and ends on last sunday in october
+// at 3:00 (2:00 standard time). Both instants are calculated once a year as minute of year
+// in standard time, so summertime is just a comparison
 void Timer::calculateSummertime() {
-    // first we do easy win
-    mIsSummertime = false;
+    mSummertimeStart = 0;
+    mSummertimeEnd = 0;
     if (mUseSummertime) {
-      if (getMonth() == 3) {
-          // find last Sunday in March
-          uint8_t lLastSunday = calculateLastSundayInMonth(3);
-          if (lLastSunday == mNow.tm_mday) {
-              // we have to take time into account
-              mIsSummertime = (mNow.tm_hour > 3);
-          } else {
-              mIsSummertime = (lLastSunday < mNow.tm_mday);
-          }
-      } else if (getMonth() == 10) {
-          // find last Sunday in October
-          uint8_t lLastSunday = calculateLastSundayInMonth(10);
-          if (lLastSunday == mNow.tm_mday)
-          {
-              // we have to take time into account
-              // here might be a problem if called between 
-              // 2 and 3, because these times exist in both
-              // summer and wintertime. This is currently
-              // mitigated with the fact, that this routine
-              // is called only once at 03:01. Currently just used
-              // for sunrise/sunset calculation, so calling
-              // time is no problem.
-              mIsSummertime = (mNow.tm_hour < 3);
-          }
-          else
-          {
-              mIsSummertime = (lLastSunday > mNow.tm_mday);
-          }
-      } else {
-          mIsSummertime = (getMonth() > 3 && getMonth() < 10);
-      }
+        mSummertimeStart = getLastSundayInMonth(3) * 1440L + 120;
+        mSummertimeEnd = getLastSundayInMonth(10) * 1440L + 120;
     }
 }
 
+// iMinuteOfDay is standard time of current day
+bool Timer::isSummertime(int16_t iMinuteOfDay) {
+    uint32_t lMinuteOfYear = mNow.tm_yday * 1440L + iMinuteOfDay;
+    return lMinuteOfYear >= mSummertimeStart && lMinuteOfYear < mSummertimeEnd;
+}
+
 void Timer::calculateAdvent() {
     // calculates the 4th advent
     mTimeHelper.tm_year = mNow.tm_year;
@@ -314,46 +473,62 @@ void Timer::debug()
 #endif
 }
 
-void Timer::calculateHolidays(bool iDebugOutput) {
-    // we check only if date is valid
-    if (mTimeValid < tmDateValid)
-        return;
-    // check if today or tomorrow is a holiday
-    sDay lToday = {(int8_t)getDay(), (int8_t)getMonth()};
-    sDay lTomorrow = getDayByOffset(1, lToday);
-    uint8_t lHolidayToday = 0;
-    uint8_t lHolidayTomorrow = 0;
+uint16_t Timer::getDayOfYear(int8_t iDay, int8_t iMonth) {
+    static const uint16_t cDaysBeforeMonth[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+    return cDaysBeforeMonth[iMonth - 1] + iDay - 1 + ((iMonth > 2 && isLeapYear(getYear())) ? 1 : 0);
+}
+
+// builds holiday index for the whole year, has to be called after easter and advent calculation
+void Timer::calculateHolidayTable(bool iDebugOutput) {
+    for (uint16_t lDay = 0; lDay < 366; lDay++)
+        sHolidayTable[lDay] = 0;
     for (uint8_t i = 0; i < 29; i++)
     {
-        sDay lHoliday = {REMOVED, REMOVED};
+        int16_t lDayOfYear = -1;
         switch (cHolidays[i].month)
         {
             case REMOVED:
                 // do nothing
                 break;
             case EASTER:
-                lHoliday = getDayByOffset(cHolidays[i].day, mEaster);
+                lDayOfYear = getDayOfYear(mEaster.day, mEaster.month) + cHolidays[i].day;
                 break;
             case ADVENT:
-                lHoliday = getDayByOffset(cHolidays[i].day, mAdvent);
-                // do nothing
+                lDayOfYear = getDayOfYear(mAdvent.day, mAdvent.month) + cHolidays[i].day;
                 break;
             default:
                 // constant holiday
-                lHoliday = cHolidays[i];
+                lDayOfYear = getDayOfYear(cHolidays[i].day, cHolidays[i].month);
                 break;
         }
-        if (lHoliday.month > REMOVED) {
+        if (lDayOfYear >= 0 && lDayOfYear < 366)
+        {
             if (iDebugOutput)
-                printDebug("%02d.%02d., ", lHoliday.day, lHoliday.month);
-            if (isEqualDate(lHoliday, lToday))
-                lHolidayToday = i + 1;
-            if (isEqualDate(lHoliday, lTomorrow))
-                lHolidayTomorrow = i + 1;
-            if (lHolidayToday > 0 && lHolidayTomorrow > 0 && !iDebugOutput)
-                break;
+            {
+                uint8_t lMonth = 12;
+                while (getDayOfYear(1, lMonth) > lDayOfYear)
+                    lMonth--;
+                printDebug("%02d.%02d., ", lDayOfYear - getDayOfYear(1, lMonth) + 1, lMonth);
+            }
+            sHolidayTable[lDayOfYear] = i + 1;
         }
     }
+    sHolidayTableYear = mNow.tm_year;
+}
+
+void Timer::calculateHolidays(bool iDebugOutput) {
+    // we check only if date is valid
+    if (mTimeValid < tmDateValid)
+        return;
+    // holiday table is shared with TimerRestore, which might have used an other year
+    if (sHolidayTableYear != mNow.tm_year || iDebugOutput)
+        calculateHolidayTable(iDebugOutput);
+    // check if today or tomorrow is a holiday
+    uint16_t lTomorrow = mNow.tm_yday + 1;
+    if (lTomorrow > getDayOfYear(31, 12))
+        lTomorrow = 0; // new year
+    uint8_t lHolidayToday = sHolidayTable[mNow.tm_yday];
+    uint8_t lHolidayTomorrow = sHolidayTable[lTomorrow];
     if (lHolidayToday != mHolidayToday) {
         mHolidayToday = lHolidayToday;
         mHolidayChanged = true;
@@ -364,29 +539,6 @@ void Timer::calculateHolidays(bool iDebugOutput) {
     }
 }
 
-bool Timer::isEqualDate(sDay &iDate1, sDay &iDate2) {
-    return (iDate1.day == iDate2.day && iDate1.month == iDate2.month);
-}
-
-sDay Timer::getDayByOffset(int8_t iOffset, sDay &iDate) {
-    mTimeHelper.tm_year = mNow.tm_year;
-    mTimeHelper.tm_mon = iDate.month - 1;
-    mTimeHelper.tm_mday = iDate.day + iOffset;
-    mTimeHelper.tm_hour = 12;
-    mTimeHelper.tm_min = 0;
-    mTimeHelper.tm_sec = 0;
-
-    // save a little time, if we are for sure within same month
-    if (mTimeHelper.tm_mday < 1 || mTimeHelper.tm_mday > 28)
-        mktime(&mTimeHelper); //   -timezone;
-
-    //time_t nt_seconds = mktime(&mTimeHelper);     //   -timezone;
-    // return gmtime(&nt_seconds);
-
-    sDay lResult = {(int8_t)mTimeHelper.tm_mday, (int8_t)(mTimeHelper.tm_mon + 1)};
-    return lResult;
-}
-
 /***************************************************************************/
 /* Note: year,month,date = calendar date, 1801-2099 only.             */
 /*       Eastern longitude positive, Western longitude negative       */
@@ -416,10 +568,11 @@ sDay Timer::getDayByOffset(int8_t iOffset, sDay &iDate) {
 /*                    both set to the time when the sun is at south.  */
 /*                                                                    */
 /**********************************************************************/
-int Timer::sunRiseSet(int year, int month, int day, double lon, double lat,
-                      double altit, int upper_limb, double *trise, double *tset)
+int Timer::sunRiseSet(int year, int month, int day, sunfloat_t lon, sunfloat_t lat,
+                      sunfloat_t altit, int upper_limb, sunfloat_t *trise, sunfloat_t *tset)
 {
-    double d,    /* Days since 2000 Jan 0.0 (negative before) */
+    long days;       /* Whole days since 2000 Jan 0.0 (negative before) */
+    sunfloat_t fraction, /* Fraction of day, days + fraction is d of original algorithm */
         sr,      /* Solar distance, astronomical units */
         sRA,     /* Sun's Right Ascension */
         sdec,    /* Sun's declination */
@@ -430,20 +583,22 @@ int Timer::sunRiseSet(int year, int month, int day, double lon, double lat,
 
     int rc = 0; /* Return cde from function - usually 0 */
 
-    /* Compute d of 12h local mean solar time */
-    d = days_since_2000_Jan_0(year, month, day) + 0.5 - lon / 360.0;
+    /* Compute d of 12h local mean solar time, whole days are kept separately, */
+    /* a float cannot resolve minutes of a day count near 36500 (year 2099)    */
+    days = days_since_2000_Jan_0(year, month, day);
+    fraction = SUN_F(0.5) - lon / SUN_F(360.0);
 
     /* Compute the local sidereal time of this moment */
-    sidtime = revolution(GMST0(d) + 180.0 + lon);
+    sidtime = revolution(GMST0(days, fraction) + SUN_F(180.0) + lon);
 
     /* Compute Sun's RA, Decl and distance at this moment */
-    sunRadDec(d, &sRA, &sdec, &sr);
+    sunRadDec(days, fraction, &sRA, &sdec, &sr);
 
     /* Compute time when Sun is at south - in hours UT */
-    tsouth = 12.0 - rev180(sidtime - sRA) / 15.0;
+    tsouth = SUN_F(12.0) - rev180(sidtime - sRA) / SUN_F(15.0);
 
     /* Compute the Sun's apparent radius in degrees */
-    sradius = 0.2666 / sr;
+    sradius = SUN_F(0.2666) / sr;
 
     /* Do correction to upper limb, if necessary */
     if (upper_limb)
@@ -452,15 +607,15 @@ int Timer::sunRiseSet(int year, int month, int day, double lon, double lat,
     /* Compute the diurnal arc that the Sun traverses to reach */
     /* the specified altitude altit: */
     {
-        double cost;
+        sunfloat_t cost;
         cost = (sind(altit) - sind(lat) * sind(sdec)) /
                (cosd(lat) * cosd(sdec));
-        if (cost >= 1.0)
-            rc = -1, t = 0.0; /* Sun always below altit */
-        else if (cost <= -1.0)
-            rc = +1, t = 12.0; /* Sun always above altit */
+        if (cost >= SUN_F(1.0))
+            rc = -1, t = SUN_F(0.0); /* Sun always below altit */
+        else if (cost <= -SUN_F(1.0))
+            rc = +1, t = SUN_F(12.0); /* Sun always above altit */
         else
-            t = acosd(cost) / 15.0; /* The diurnal arc, hours */
+            t = acosd(cost) / SUN_F(15.0); /* The diurnal arc, hours */
     }
 
     /* Store rise and set times - in hours UT */
@@ -476,9 +631,10 @@ int Timer::sunRiseSet(int year, int month, int day, double lon, double lat,
 /* 2000 Jan 0.0.  The Sun's ecliptic latitude is not  */
 /* computed, since it's always very near 0.           */
 /******************************************************/
-void Timer::sunPos(double d, double *lon, double *r)
+void Timer::sunPos(long days, sunfloat_t fraction, sunfloat_t *lon, sunfloat_t *r)
 {
-    double M, /* Mean anomaly of the Sun */
+    sunfloat_t d = days + fraction;
+    sunfloat_t M, /* Mean anomaly of the Sun */
         w,    /* Mean longitude of perihelion */
               /* Note: Sun's mean longitude = M + w */
         e,    /* Eccentricity of Earth's orbit */
@@ -487,19 +643,19 @@ void Timer::sunPos(double d, double *lon, double *r)
         v;    /* True anomaly */
 
     /* Compute mean elements */
-    M = revolution(356.0470 + 0.9856002585 * d);
-    w = 282.9404 + 4.70935E-5 * d;
-    e = 0.016709 - 1.151E-9 * d;
+    M = dailyAngle(SUN_F(356.0470), SUN_F(0.9856002585 - 1.0), days, fraction);
+    w = SUN_F(282.9404) + SUN_F(4.70935E-5) * d;
+    e = SUN_F(0.016709) - SUN_F(1.151E-9) * d;
 
     /* Compute true longitude and radius vector */
-    E = M + e * RADEG * sind(M) * (1.0 + e * cosd(M));
+    E = M + e * RADEG * sind(M) * (SUN_F(1.0) + e * cosd(M));
     x = cosd(E) - e;
-    y = sqrt(1.0 - e * e) * sind(E);
-    *r = sqrt(x * x + y * y); /* Solar distance */
+    y = SUN_SQRT(SUN_F(1.0) - e * e) * sind(E);
+    *r = SUN_SQRT(x * x + y * y); /* Solar distance */
     v = atan2d(y, x);         /* True anomaly */
     *lon = v + w;             /* True solar longitude */
-    if (*lon >= 360.0)
-        *lon -= 360.0; /* Make it 0..360 degrees */
+    if (*lon >= SUN_F(360.0))
+        *lon -= SUN_F(360.0); /* Make it 0..360 degrees */
 }
 
 /******************************************************/
@@ -507,19 +663,20 @@ void Timer::sunPos(double d, double *lon, double *r)
 /* and also its distance, at an instant given in d,   */
 /* the number of days since 2000 Jan 0.0.             */
 /******************************************************/
-void Timer::sunRadDec(double d, double *RA, double *dec, double *r)
+void Timer::sunRadDec(long days, sunfloat_t fraction, sunfloat_t *RA, sunfloat_t *dec, sunfloat_t *r)
 {
-    double lon, obl_ecl, x, y, z;
+    sunfloat_t d = days + fraction;
+    sunfloat_t lon, obl_ecl, x, y, z;
 
     /* Compute Sun's ecliptical coordinates */
-    sunPos(d, &lon, r);
+    sunPos(days, fraction, &lon, r);
 
     /* Compute ecliptic rectangular coordinates (z=0) */
     x = *r * cosd(lon);
     y = *r * sind(lon);
 
     /* Compute obliquity of ecliptic (inclination of Earth's axis) */
-    obl_ecl = 23.4393 - 3.563E-7 * d;
+    obl_ecl = SUN_F(23.4393) - SUN_F(3.563E-7) * d;
 
     /* Convert to equatorial rectangular coordinates - x is unchanged */
     z = y * sind(obl_ecl);
@@ -527,7 +684,7 @@ void Timer::sunRadDec(double d, double *RA, double *dec, double *r)
 
     /* Convert to spherical coordinates */
     *RA = atan2d(y, x);
-    *dec = atan2d(z, sqrt(x * x + y * y));
+    *dec = atan2d(z, SUN_SQRT(x * x + y * y));
 
 }
 
@@ -537,22 +694,33 @@ void Timer::sunRadDec(double d, double *RA, double *dec, double *r)
 /* result is >= 0.0 and < 360.0                                   */
 /******************************************************************/
 
-#define INV360 (1.0 / 360.0)
+#define INV360 (SUN_F(1.0) / SUN_F(360.0))
 
 /*****************************************/
 /* Reduce angle to within 0..360 degrees */
 /*****************************************/
-double Timer::revolution(double x)
+sunfloat_t Timer::revolution(sunfloat_t x)
 {
-    return (x - 360.0 * floor(x * INV360));
+    return (x - SUN_F(360.0) * SUN_FLOOR(x * INV360));
 }
 
 /*********************************************/
 /* Reduce angle to within +180..+180 degrees */
 /*********************************************/
-double Timer::rev180(double x)
+sunfloat_t Timer::rev180(sunfloat_t x)
+{
+    return (x - SUN_F(360.0) * SUN_FLOOR(x * INV360 + SUN_F(0.5)));
+}
+
+/*****************************************************************/
+/* Angle, which increases by 1 + rateOffset degrees per day.     */
+/* Full revolutions of whole days are removed exactly before the */
+/* small rate offset is applied, so single precision keeps its   */
+/* resolution for any day count.                                 */
+/*****************************************************************/
+sunfloat_t Timer::dailyAngle(sunfloat_t base, sunfloat_t rateOffset, long days, sunfloat_t fraction)
 {
-    return (x - 360.0 * floor(x * INV360 + 0.5));
+    return revolution(base + (sunfloat_t)(days % 360) + rateOffset * days + (SUN_F(1.0) + rateOffset) * fraction);
 }
 
 /*******************************************************************/
@@ -581,15 +749,15 @@ double Timer::rev180(double x)
 /*                                                                 */
 /*******************************************************************/
 
-double Timer::GMST0(double d)
+sunfloat_t Timer::GMST0(long days, sunfloat_t fraction)
 {
-    double sidtim0;
+    sunfloat_t sidtim0;
     /* Sidtime at 0h UT = L (Sun's mean longitude) + 180.0 degr  */
     /* L = M + w, as defined in sunpos().  Since I'm too lazy to */
     /* add these numbers, I'll let the C compiler do it for me.  */
     /* Any decent C compiler will add the constants at compile   */
     /* time, imposing no runtime or code overhead.               */
-    sidtim0 = revolution((180.0 + 356.0470 + 282.9404) +
-                         (0.9856002585 + 4.70935E-5) * d);
+    sidtim0 = dailyAngle(SUN_F(180.0 + 356.0470 + 282.9404),
+                         SUN_F(0.9856002585 + 4.70935E-5 - 1.0), days, fraction);
     return sidtim0;
 } /* GMST0 */
@@ -10,8 +10,38 @@
 #include <math.h>
 #include <ctime>
 
+// SUN_SINGLE_PRECISION calculates sunrise/sunset with float instead of double,
+// which is much faster on targets without FPU and still accurate to the minute
+#ifdef SUN_SINGLE_PRECISION
+typedef float sunfloat_t;
+#define SUN_SIN sinf
+#define SUN_COS cosf
+#define SUN_TAN tanf
+#define SUN_ATAN atanf
+#define SUN_ASIN asinf
+#define SUN_ACOS acosf
+#define SUN_ATAN2 atan2f
+#define SUN_SQRT sqrtf
+#define SUN_FLOOR floorf
+#define SUN_ROUND roundf
+#else
+typedef double sunfloat_t;
+#define SUN_SIN sin
+#define SUN_COS cos
+#define SUN_TAN tan
+#define SUN_ATAN atan
+#define SUN_ASIN asin
+#define SUN_ACOS acos
+#define SUN_ATAN2 atan2
+#define SUN_SQRT sqrt
+#define SUN_FLOOR floor
+#define SUN_ROUND round
+#endif
+#define SUN_F(x) ((sunfloat_t)(x))
+
 #define SUN_SUNRISE 0x00
 #define SUN_SUNSET 0x01
+#define SUN_UNKNOWN 0x7FFF // sun table entry not calculated yet
 
 #define REMOVED 0
 #define EASTER -1
@@ -29,6 +59,25 @@ struct sDay
     int8_t month;
 };
 
+// clock discipline: the local clock is corrected by the drift measured between time telegrams,
+// time is requested from bus just if the estimated error exceeds TIMER_MAX_ERROR_MS
+#ifndef TIMER_MAX_ERROR_MS
+#define TIMER_MAX_ERROR_MS 30000
+#endif
+#define TIMER_UNKNOWN_DRIFT_PPM 1000        // assumed drift as long as it was not measured
+#define TIMER_MAX_DRIFT_PPM 20000           // larger deviations are not corrected
+#define TIMER_DRIFT_MIN_INTERVAL 3600000    // min. time between two drift measurements in ms
+#define TIMER_STEP_LIMIT_MS 60000           // larger offsets are a new time, not drift
+
+// largest part of date/time, which changed with last clock step
+enum eTimeChange
+{
+    tcSecond,
+    tcMinute,
+    tcDay,
+    tcYear
+};
+
 enum eTimeValid
 {
     tmInvalid,
@@ -42,47 +91,71 @@ class Timer
   protected:
     // sDay cHolidays[29] = {{1, 1}, {6, 1}, {-52, EASTER}, {-48, EASTER}, {-47, EASTER}, {-46, EASTER}, {-3, EASTER}, {-2, EASTER}, {0, EASTER}, {1, EASTER}, {1, 5}, {39, EASTER}, {49, EASTER}, {50, EASTER}, {60, EASTER}, {8, 8}, {15, 8}, {3, 10}, {31, 10}, {1, 11}, {-32, ADVENT}, {-21, ADVENT}, {-14, ADVENT}, {-7, ADVENT}, {0, ADVENT}, {24, 12}, {25, 12}, {26, 12}, {31, 12}};
     static sDay cHolidays[29];
+    // sunrise/sunset per day of year in minutes (standard time of configured timezone),
+    // entries are calculated on first access and valid for one year and location
+    static int16_t sSunTable[366][2];
+    static uint16_t sSunTableYear;
+    static float sSunTableLongitude;
+    static float sSunTableLatitude;
+    static int8_t sSunTableTimezone;
+    // holiday per day of year (index in cHolidays + 1, 0 = no holiday), valid for one year
+    static uint8_t sHolidayTable[366];
+    static int16_t sHolidayTableYear;
     struct tm mTimeHelper;
     // double mLongitude;
     // double mLatitude;
     // int8_t mTimezone;
-    bool mUseSummertime;
-    bool mIsSummertime;
     eTimeValid mTimeValid = tmInvalid;
     uint32_t mTimeDelay = 0;
+    uint16_t mSecondMillis = 1000;    // length of next second in millis(), corrected by drift
+    int32_t mDriftPpm = 0;            // > 0: millis() runs faster than bus time
+    int32_t mDriftAccu = 0;           // drift correction in us, not applied yet
+    uint32_t mDriftUncertaintyPpm = TIMER_UNKNOWN_DRIFT_PPM;
+    uint32_t mDriftAnchorMillis = 0;  // start of current drift measurement
+    int32_t mDriftStepAccu = 0;       // sum of offsets, the clock was stepped by since mDriftAnchorMillis
+    uint32_t mLastSyncMillis = 0;     // last time telegram, 0 = never received
     bool mMinuteChanged = false;
     uint8_t mHolidayToday = 0;
     uint8_t mHolidayTomorrow = 0;
     bool mHolidayChanged = false;
+    bool mDayChanged = false; // day dependent data (sun, holidays) was calculated for a new day
     sTime mSunrise;
     sTime mSunset;
     sDay mEaster = {0, 0}; // easter sunday
     sDay mAdvent = {0, 0}; // fourth advent
-    int8_t mMinuteTick = -1;  // timer evaluation is called each time the minute changes
-    int8_t mDayTick = -1;     // sunrise/sunset calculation happens each time the day changes
-    int16_t mYearTick = -1; // easter calculation happens each time year changes
+    eTimeChange mPendingChange = tcYear; // changes by bus telegrams, processed with next clock step
 
     void calculateEaster();
     void calculateAdvent();
     void calculateSummertime();
-    uint8_t calculateLastSundayInMonth(uint8_t iMonth);
+    uint16_t getLastSundayInMonth(uint8_t iMonth);
+    bool isSummertime(int16_t iMinuteOfDay);
     void calculateHolidays(bool iDebugOutput = false);
+    void calculateHolidayTable(bool iDebugOutput = false);
+    uint16_t getDayOfYear(int8_t iDay, int8_t iMonth);
+    eTimeChange advanceSecond();
+    void processDateChange(eTimeChange iChange);
+    void processPendingChange();
+    bool disciplineClock(tm *iTime);
+    static bool isLeapYear(uint16_t iYear);
+    static uint8_t getDaysInMonth(uint16_t iYear, uint8_t iMonth);
     void calculateSunriseSunset();
-    bool isEqualDate(sDay &iDate1, sDay &iDate2);
-    sDay getDayByOffset(int8_t iOffset, sDay &iDate);
+    int16_t *getSunTableEntry();
+    static int16_t normalizeMinuteOfDay(int16_t iMinute);
 
     Timer();
     ~Timer();
     Timer(const Timer&);    // make copy constructor private
     Timer &operator=(const Timer&); // prevent copy
 
-    int sunRiseSet(int year, int month, int day, double lon, double lat,
-                   double altit, int upper_limb, double *rise, double *set);
-    void sunPos(double d, double *lon, double *r);
-    void sunRadDec(double d, double *RA, double *dec, double *r);
-    double revolution(double x);
-    double rev180(double x);
-    double GMST0(double d);
+    int sunRiseSet(int year, int month, int day, sunfloat_t lon, sunfloat_t lat,
+                   sunfloat_t altit, int upper_limb, sunfloat_t *rise, sunfloat_t *set);
+    void sunPos(long days, sunfloat_t fraction, sunfloat_t *lon, sunfloat_t *r);
+    void sunRadDec(long days, sunfloat_t fraction, sunfloat_t *RA, sunfloat_t *dec, sunfloat_t *r);
+    sunfloat_t revolution(sunfloat_t x);
+    sunfloat_t rev180(sunfloat_t x);
+    sunfloat_t dailyAngle(sunfloat_t base, sunfloat_t rateOffset, long days, sunfloat_t fraction);
+    sunfloat_t GMST0(long days, sunfloat_t fraction);
 
   public:
     // singleton!
@@ -91,9 +164,13 @@ class Timer
     float mLongitude;
     float mLatitude;
     int8_t mTimezone;
+    bool mUseSummertime;
+    uint32_t mSummertimeStart = 0; // minute of year (standard time), 0 if summertime is not used
+    uint32_t mSummertimeEnd = 0;
 
     void setup(double iLongitude, double iLatitude, int8_t iTimezone, bool iUseSummertime, uint32_t iHolidayBitmask);
     void loop();
+    void processClockStep();
     void debug();
 
     
@@ -110,11 +187,15 @@ class Timer
     bool minuteChanged(); // true every minute
     void clearMinuteChanged(); //has to be cleared externally
     void setTimeFromBus(tm *iTime);
+    uint32_t getEstimatedError();
+    bool needsTimeSync();
     void setDateFromBus(tm *iDate);
     uint8_t holidayToday();
     uint8_t holidayTomorrow();
     bool holidayChanged();
     void clearHolidayChanged();
+    bool dayChanged();       // true after day dependent data was calculated for a new day
+    void clearDayChanged();  // has to be cleared externally
     eTimeValid isTimerValid();
 };
 
@@ -130,16 +211,16 @@ class Timer
 // #define PI 3.1415926535897932384
 // #endif
 
-#define RADEG (180.0 / PI)
-#define DEGRAD (PI / 180.0)
+#define RADEG SUN_F(180.0 / PI)
+#define DEGRAD SUN_F(PI / 180.0)
 
 /* The trigonometric functions in degrees */
 
-#define sind(x) sin((x)*DEGRAD)
-#define cosd(x) cos((x)*DEGRAD)
-#define tand(x) tan((x)*DEGRAD)
+#define sind(x) SUN_SIN((x)*DEGRAD)
+#define cosd(x) SUN_COS((x)*DEGRAD)
+#define tand(x) SUN_TAN((x)*DEGRAD)
 
-#define atand(x) (RADEG * atan(x))
-#define asind(x) (RADEG * asin(x))
-#define acosd(x) (RADEG * acos(x))
-#define atan2d(y, x) (RADEG * atan2(y, x))
+#define atand(x) (RADEG * SUN_ATAN(x))
+#define asind(x) (RADEG * SUN_ASIN(x))
+#define acosd(x) (RADEG * SUN_ACOS(x))
+#define atan2d(y, x) (RADEG * SUN_ATAN2(y, x))
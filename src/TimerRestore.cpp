@@ -22,41 +22,69 @@ TimerRestore &TimerRestore::instance() {
 }
 
 void TimerRestore::setup(Timer &iTimer) {
-    mDayIteration = 0;
+    mDayIteration = 1;
     mNow = iTimer.mNow;
     mLongitude = iTimer.mLongitude;
     mLatitude = iTimer.mLatitude;
     mTimezone = iTimer.mTimezone;
+    mUseSummertime = iTimer.mUseSummertime;
     mTimeValid = tmValid;
+    mSunInfoValid = false;
+    mHolidaysValid = false;
+    // year dependent data is calculated here and not taken from timer,
+    // which might not have processed the date change yet
     calculateEaster();
     calculateAdvent();
-    doDayCalculations();
+    calculateSummertime();
 }
 
 void TimerRestore::decreaseDay() {
     mNow.tm_mday -= 1;
+    mNow.tm_yday -= 1;
+    mNow.tm_wday = (mNow.tm_wday + 6) % 7;
+    if (mNow.tm_mday == 0)
+    {
+        if (mNow.tm_mon == 0)
+        {
+            mNow.tm_mon = 11;
+            mNow.tm_year -= 1;
+            mNow.tm_yday = isLeapYear(getYear()) ? 365 : 364;
+            calculateEaster();
+            calculateAdvent();
+            calculateSummertime();
+        }
+        else
+        {
+            mNow.tm_mon -= 1;
+        }
+        mNow.tm_mday = getDaysInMonth(getYear(), getMonth());
+    }
     // Jeder ältere Tag als "Heute" wird 
     // mit dem Tagesende (25:59:59) betrachtet
     mNow.tm_hour = 23; 
     mNow.tm_min = 59;
     mNow.tm_sec = 59;
-    doDayCalculations();
-}
-
-void TimerRestore::doDayCalculations() {
-    uint16_t lYear = mNow.tm_year;
-    mktime(&mNow);
     mDayIteration += 1;
+    mSunInfoValid = false;
+    mHolidaysValid = false;
     // printDebug("TimerRestore: Day %02d.%02d.%02d\n", this->getDay(), this->getMonth(), this->getYear());
-    calculateSummertime(); // initial summertime calculation if year changes
+}
+
+// sunrise and sunset are expensive, they are calculated just once for a day and only if requested
+void TimerRestore::prepareSunInfo() {
+    if (mSunInfoValid)
+        return;
     calculateSunriseSunset();
-    if (lYear != mNow.tm_year) {
-        calculateEaster();
-        calculateAdvent();
-    }
+    mSunInfoValid = true;
+}
+
+void TimerRestore::prepareHolidays() {
+    if (mHolidaysValid)
+        return;
     calculateHolidays();
+    mHolidaysValid = true;
 }
 
 uint16_t TimerRestore::getDayIteration() {
     return mDayIteration;
-}
\ No newline at end of file
+}
@@ -2,7 +2,9 @@
 
 /***********************************
  * 
- * This timer is just use for timer restore function during startup
+ * This timer is just use for timer restore function during startup.
+ * Days are stepped back without mktime, sunrise/sunset and holidays
+ * are just calculated for days, which are checked by a timer channel.
  * 
  * *********************************/
 
@@ -15,14 +17,17 @@ class TimerRestore : public Timer
     ~TimerRestore();
     TimerRestore(const TimerRestore&);    // make copy constructor private
     TimerRestore &operator=(const TimerRestore&); // prevent copy
-    void doDayCalculations();
     uint16_t mDayIteration = 0;
+    bool mSunInfoValid = false;
+    bool mHolidaysValid = false;
 
   public:
     // singleton!
     static TimerRestore &instance();
     void setup(Timer &iTimer);
     void decreaseDay();
+    void prepareSunInfo();
+    void prepareHolidays();
     uint16_t getDayIteration();
 };
 
@@ -0,0 +1,160 @@
+#include "TimingWheel.h"
+#include "Arduino.h"
+
+TimingWheel::TimingWheel()
+{
+}
+
+TimingWheel::~TimingWheel()
+{
+}
+
+TimingWheel &TimingWheel::instance()
+{
+    static TimingWheel sInstance;
+    return sInstance;
+}
+
+void TimingWheel::setup(uint16_t iNumTimers, timerExpiredCallback iCallback)
+{
+    mNumTimers = iNumTimers;
+    mCallback = iCallback;
+    uint16_t lNumLinks = iNumTimers + TW_LEVELS * TW_SLOTS + 1;
+    mNext = new uint16_t[lNumLinks];
+    mPrev = new uint16_t[lNumLinks];
+    mExpires = new uint32_t[iNumTimers];
+    // all timers are stopped and all lists are empty
+    for (uint16_t lIndex = 0; lIndex < lNumLinks; lIndex++)
+    {
+        mNext[lIndex] = lIndex;
+        mPrev[lIndex] = lIndex;
+    }
+    mCurrentTick = 0;
+    mLastTickMillis = millis();
+}
+
+uint16_t TimingWheel::slotHead(uint8_t iLevel, uint8_t iSlot)
+{
+    return mNumTimers + iLevel * TW_SLOTS + iSlot;
+}
+
+uint16_t TimingWheel::expiredHead()
+{
+    return mNumTimers + TW_LEVELS * TW_SLOTS;
+}
+
+// sorts a timer into the slot matching its remaining ticks
+void TimingWheel::link(uint16_t iTimerId)
+{
+    uint32_t lExpires = mExpires[iTimerId];
+    uint32_t lDelta = lExpires - mCurrentTick;
+    uint8_t lLevel = 0;
+    while (lLevel < TW_LEVELS - 1 && lDelta >= (1UL << (TW_LEVEL_BITS * (lLevel + 1))))
+        lLevel++;
+    uint16_t lHead = slotHead(lLevel, (lExpires >> (TW_LEVEL_BITS * lLevel)) & TW_SLOT_MASK);
+    // append at the end of the slot list
+    mNext[iTimerId] = lHead;
+    mPrev[iTimerId] = mPrev[lHead];
+    mNext[mPrev[lHead]] = iTimerId;
+    mPrev[lHead] = iTimerId;
+}
+
+void TimingWheel::unlink(uint16_t iTimerId)
+{
+    mNext[mPrev[iTimerId]] = mNext[iTimerId];
+    mPrev[mNext[iTimerId]] = mPrev[iTimerId];
+    mNext[iTimerId] = iTimerId;
+    mPrev[iTimerId] = iTimerId;
+}
+
+// moves a whole slot list to the (empty) list of expired timers
+void TimingWheel::moveSlotToExpired(uint16_t iHead)
+{
+    uint16_t lExpired = expiredHead();
+    if (mNext[iHead] == iHead)
+        return;
+    mNext[lExpired] = mNext[iHead];
+    mPrev[lExpired] = mPrev[iHead];
+    mPrev[mNext[lExpired]] = lExpired;
+    mNext[mPrev[lExpired]] = lExpired;
+    mNext[iHead] = iHead;
+    mPrev[iHead] = iHead;
+}
+
+// timers of a higher level slot are sorted again into lower levels
+void TimingWheel::cascade(uint8_t iLevel, uint8_t iSlot)
+{
+    uint16_t lExpired = expiredHead();
+    moveSlotToExpired(slotHead(iLevel, iSlot));
+    while (mNext[lExpired] != lExpired)
+    {
+        uint16_t lTimerId = mNext[lExpired];
+        unlink(lTimerId);
+        link(lTimerId);
+    }
+}
+
+void TimingWheel::processTick()
+{
+    uint8_t lSlot = mCurrentTick & TW_SLOT_MASK;
+    // as soon as a level wraps, the next slot of the next level is due
+    for (uint8_t lLevel = 1; lSlot == 0 && lLevel < TW_LEVELS; lLevel++)
+    {
+        lSlot = (mCurrentTick >> (TW_LEVEL_BITS * lLevel)) & TW_SLOT_MASK;
+        cascade(lLevel, lSlot);
+    }
+    lSlot = mCurrentTick & TW_SLOT_MASK;
+    mCurrentTick++;
+    // the callback may start timers again, so we process a detached list
+    uint16_t lExpired = expiredHead();
+    moveSlotToExpired(slotHead(0, lSlot));
+    while (mNext[lExpired] != lExpired)
+    {
+        uint16_t lTimerId = mNext[lExpired];
+        unlink(lTimerId);
+        mCallback(lTimerId);
+    }
+}
+
+// starts (or restarts) a timer, which expires after iDelay ms
+void TimingWheel::start(uint16_t iTimerId, uint32_t iDelay)
+{
+    if (iTimerId >= mNumTimers)
+        return;
+    uint32_t lTicks = iDelay / TW_TICK_MS + ((iDelay % TW_TICK_MS) ? 1 : 0);
+    if (lTicks > TW_MAX_TICKS)
+        lTicks = TW_MAX_TICKS;
+    unlink(iTimerId);
+    mExpires[iTimerId] = mCurrentTick + lTicks;
+    link(iTimerId);
+}
+
+void TimingWheel::stop(uint16_t iTimerId)
+{
+    if (iTimerId < mNumTimers)
+        unlink(iTimerId);
+}
+
+bool TimingWheel::isRunning(uint16_t iTimerId)
+{
+    return iTimerId < mNumTimers && mNext[iTimerId] != iTimerId;
+}
+
+// remaining time in ms until timer expires
+uint32_t TimingWheel::remaining(uint16_t iTimerId)
+{
+    if (!isRunning(iTimerId))
+        return 0;
+    return (mExpires[iTimerId] - mCurrentTick) * TW_TICK_MS;
+}
+
+// processes all ticks passed since last call
+void TimingWheel::loop()
+{
+    if (mNumTimers == 0)
+        return;
+    uint32_t lTicks = (millis() - mLastTickMillis) / TW_TICK_MS;
+    mLastTickMillis += lTicks * TW_TICK_MS;
+    while (lTicks--)
+        processTick();
+}
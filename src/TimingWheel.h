@@ -0,0 +1,62 @@
+#pragma once
+
+/***********************************
+ *
+ * Hierarchical timing wheel for all delays of logic channels
+ *
+ * Each delay is identified by a timer id. A running delay is linked
+ * into exactly one slot of the wheel, so the cost per tick does not
+ * depend on the number of running delays. Ticks are derived from
+ * millis() with wrap safe arithmetic, delays up to 1000 h are supported.
+ *
+ * *********************************/
+
+#include <stdint.h>
+
+#define TW_TICK_MS 10                       // resolution of the wheel in ms
+#define TW_LEVEL_BITS 5                     // 32 slots per level
+#define TW_SLOTS (1 << TW_LEVEL_BITS)
+#define TW_SLOT_MASK (TW_SLOTS - 1)
+#define TW_LEVELS 6                         // 32^6 ticks = 2982 h
+#define TW_MAX_TICKS ((1UL << (TW_LEVEL_BITS * TW_LEVELS)) - 1)
+
+typedef void (*timerExpiredCallback)(uint16_t iTimerId);
+
+class TimingWheel
+{
+  private:
+    TimingWheel();
+    ~TimingWheel();
+    TimingWheel(const TimingWheel&);            // make copy constructor private
+    TimingWheel &operator=(const TimingWheel&); // prevent copy
+
+    uint16_t mNumTimers = 0;
+    // double linked lists, index < mNumTimers is a timer, all other indexes are list heads:
+    // one head for each slot of each level and one head for the list of expired timers.
+    // A timer, which is not running, is linked to itself.
+    uint16_t *mNext = nullptr;
+    uint16_t *mPrev = nullptr;
+    uint32_t *mExpires = nullptr; // tick, at which a timer expires
+    uint32_t mCurrentTick = 0;    // next tick to process
+    uint32_t mLastTickMillis = 0;
+    timerExpiredCallback mCallback = nullptr;
+
+    uint16_t slotHead(uint8_t iLevel, uint8_t iSlot);
+    uint16_t expiredHead();
+    void link(uint16_t iTimerId);
+    void unlink(uint16_t iTimerId);
+    void moveSlotToExpired(uint16_t iHead);
+    void cascade(uint8_t iLevel, uint8_t iSlot);
+    void processTick();
+
+  public:
+    // singleton!
+    static TimingWheel &instance();
+
+    void setup(uint16_t iNumTimers, timerExpiredCallback iCallback);
+    void start(uint16_t iTimerId, uint32_t iDelay);
+    void stop(uint16_t iTimerId);
+    bool isRunning(uint16_t iTimerId);
+    uint32_t remaining(uint16_t iTimerId);
+    void loop();
+};
@@ -45,7 +45,7 @@ void loop()
     // don't delay here to much. Otherwise you might lose packages or mess up the timing with ETS
     knx.loop();
 
-    // only run the application code if the device was configured with ETS
-    if (knx.configured())
-        appLoop();
+    // application code checks itself, if the device was configured with ETS,
+    // otherwise it just finishes pending EEPROM writes
+    appLoop();
 }
\ No newline at end of file